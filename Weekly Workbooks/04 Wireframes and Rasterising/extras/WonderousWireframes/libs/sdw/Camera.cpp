@@ -0,0 +1,91 @@
+#include "Camera.h"
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+// Shared by every camera, so that no two states of any cameras ever have the same version
+std::atomic<uint64_t> lastVersion{0};
+
+}
+
+Camera::Camera(glm::vec3 position, float focalLength) :
+		cameraPosition(position),
+		cameraOrientation(1.0f),
+		cameraFocalLength(focalLength),
+		cameraVersion(++lastVersion) {}
+
+glm::vec3 Camera::position() const {
+	return cameraPosition;
+}
+
+const glm::mat3 &Camera::orientation() const {
+	return cameraOrientation;
+}
+
+glm::vec3 Camera::right() const {
+	return cameraOrientation[0];
+}
+
+glm::vec3 Camera::up() const {
+	return cameraOrientation[1];
+}
+
+glm::vec3 Camera::forward() const {
+	return -cameraOrientation[2];
+}
+
+float Camera::focalLength() const {
+	return cameraFocalLength;
+}
+
+uint64_t Camera::version() const {
+	return cameraVersion;
+}
+
+void Camera::setPosition(glm::vec3 newPosition) {
+	if (newPosition == cameraPosition) return;
+	cameraPosition = newPosition;
+	changed();
+}
+
+void Camera::setOrientation(const glm::mat3 &newOrientation) {
+	if (newOrientation == cameraOrientation) return;
+	cameraOrientation = newOrientation;
+	changed();
+}
+
+void Camera::setFocalLength(float newFocalLength) {
+	if (newFocalLength == cameraFocalLength) return;
+	cameraFocalLength = newFocalLength;
+	changed();
+}
+
+void Camera::translate(glm::vec3 offset) {
+	setPosition(cameraPosition + cameraOrientation * offset);
+}
+
+void Camera::lookAt(glm::vec3 target, glm::vec3 worldUp) {
+	glm::vec3 backward = cameraPosition - target;
+	glm::vec3 right = glm::cross(worldUp, backward);
+	if (glm::length(backward) == 0.0f || glm::length(right) == 0.0f) return;
+	backward = glm::normalize(backward);
+	right = glm::normalize(right);
+	setOrientation(glm::mat3(right, glm::cross(backward, right), backward));
+}
+
+void Camera::orbit(glm::vec3 centre, float angle) {
+	float c = std::cos(angle);
+	float s = std::sin(angle);
+	glm::mat3 rotation(c, 0.0f, -s, 0.0f, 1.0f, 0.0f, s, 0.0f, c);
+	setPosition(centre + rotation * (cameraPosition - centre));
+	setOrientation(rotation * cameraOrientation);
+}
+
+Projection Camera::projection(float imagePlaneScale, float canvasWidth, float canvasHeight) const {
+	return Projection{cameraPosition, cameraOrientation, cameraFocalLength, imagePlaneScale, canvasWidth, canvasHeight};
+}
+
+void Camera::changed() {
+	cameraVersion = ++lastVersion;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Projection.h"
+
+// A pinhole camera: where it is, which way it faces and its focal length. Every change gives it a new
+// version(), never used by any other change to any camera, so anything worked out from a camera (projected
+// vertices, a rendered frame) can be kept for as long as the version it was worked out for is current.
+class Camera {
+public:
+	// Facing down -z, with y up
+	Camera(glm::vec3 position, float focalLength);
+
+	glm::vec3 position() const;
+	// The columns are the camera's right, up and backward axes, in world space
+	const glm::mat3 &orientation() const;
+	glm::vec3 right() const;
+	glm::vec3 up() const;
+	glm::vec3 forward() const;
+	float focalLength() const;
+	uint64_t version() const;
+
+	// Setting what's already there doesn't count as a change
+	void setPosition(glm::vec3 newPosition);
+	// newOrientation must be a rotation (orthonormal, with right-handed axes)
+	void setOrientation(const glm::mat3 &newOrientation);
+	void setFocalLength(float newFocalLength);
+	// offset is along the camera's own axes: x right, y up and z backward
+	void translate(glm::vec3 offset);
+	// Turns to face target, keeping worldUp as near to up as it can. Does nothing if target is where the
+	// camera is, or straight along worldUp from it.
+	void lookAt(glm::vec3 target, glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f));
+	// Swings the camera angle radians (anticlockwise, seen from above) round the vertical axis through
+	// centre, turning it along with the swing
+	void orbit(glm::vec3 centre, float angle);
+
+	Projection projection(float imagePlaneScale, float canvasWidth, float canvasHeight) const;
+
+private:
+	glm::vec3 cameraPosition;
+	glm::mat3 cameraOrientation;
+	float cameraFocalLength;
+	uint64_t cameraVersion;
+
+	void changed();
+};
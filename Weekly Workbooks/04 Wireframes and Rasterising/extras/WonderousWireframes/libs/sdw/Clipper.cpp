@@ -0,0 +1,117 @@
+#include "Clipper.h"
+#include <cmath>
+
+namespace {
+
+struct ClipVertex {
+	glm::vec3 position;
+	TexturePoint texturePoint;
+};
+
+ClipVertex lerp(const ClipVertex &from, const ClipVertex &to, float t) {
+	ClipVertex result;
+	result.position = from.position + (to.position - from.position) * t;
+	result.texturePoint = TexturePoint(from.texturePoint.x + (to.texturePoint.x - from.texturePoint.x) * t,
+	                                   from.texturePoint.y + (to.texturePoint.y - from.texturePoint.y) * t);
+	return result;
+}
+
+// One Sutherland-Hodgman pass: keeps the part of the polygon where distance() >= 0
+template <typename Vertex, typename Distance, typename Interpolate>
+int clipPolygon(const Vertex *input, int count, Vertex *output, Distance distance, Interpolate interpolate) {
+	int written = 0;
+	for (int i = 0; i < count; i++) {
+		const Vertex &current = input[i];
+		const Vertex &next = input[(i + 1) % count];
+		float currentDistance = distance(current);
+		float nextDistance = distance(next);
+		if (currentDistance >= 0.0f) output[written++] = current;
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f)) {
+			float t = currentDistance / (currentDistance - nextDistance);
+			output[written++] = interpolate(current, next, t);
+		}
+	}
+	return written;
+}
+
+// On screen, 1/z is linear but texture coordinates are not, so interpolate u/z and v/z and divide back out
+CanvasPoint interpolateProjected(const CanvasPoint &from, const CanvasPoint &to, float t) {
+	CanvasPoint result(from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t,
+	                   from.depth + (to.depth - from.depth) * t,
+	                   from.brightness + (to.brightness - from.brightness) * t);
+	if (from.depth > 0.0f && to.depth > 0.0f) {
+		float u = from.texturePoint.x * from.depth + (to.texturePoint.x * to.depth - from.texturePoint.x * from.depth) * t;
+		float v = from.texturePoint.y * from.depth + (to.texturePoint.y * to.depth - from.texturePoint.y * from.depth) * t;
+		result.texturePoint = TexturePoint(u / result.depth, v / result.depth);
+	} else {
+		result.texturePoint = TexturePoint(from.texturePoint.x + (to.texturePoint.x - from.texturePoint.x) * t,
+		                                   from.texturePoint.y + (to.texturePoint.y - from.texturePoint.y) * t);
+	}
+	return result;
+}
+
+}
+
+glm::vec4 nearPlane(glm::vec3 cameraPosition, glm::vec3 forward, float nearDistance) {
+	forward = glm::normalize(forward);
+	return glm::vec4(forward, -glm::dot(forward, cameraPosition) - nearDistance);
+}
+
+int clipToPlane(const ModelTriangle &triangle, const glm::vec4 &plane, ModelTriangle out[MAX_NEAR_CLIPPED_TRIANGLES]) {
+	ClipVertex input[3];
+	for (int i = 0; i < 3; i++) input[i] = ClipVertex{triangle.vertices[i], triangle.texturePoints[i]};
+	auto distance = [&plane](const ClipVertex &vertex) {
+		return glm::dot(glm::vec3(plane), vertex.position) + plane.w;
+	};
+	// the common cases, wholly in front or wholly behind, don't need the polygon at all
+	int inFront = 0;
+	for (const ClipVertex &vertex : input) inFront += distance(vertex) >= 0.0f;
+	if (inFront == 3) {
+		out[0] = triangle;
+		return 1;
+	}
+	if (inFront == 0) return 0;
+
+	ClipVertex polygon[4];
+	int count = clipPolygon(input, 3, polygon, distance, lerp);
+	int triangles = 0;
+	for (int i = 1; i + 1 < count; i++) {
+		ModelTriangle &result = out[triangles++];
+		result = triangle;
+		const ClipVertex *fan[3] = {&polygon[0], &polygon[i], &polygon[i + 1]};
+		for (int j = 0; j < 3; j++) {
+			result.vertices[j] = fan[j]->position;
+			result.texturePoints[j] = fan[j]->texturePoint;
+		}
+	}
+	return triangles;
+}
+
+int clipToGuardBand(const CanvasTriangle &triangle, float width, float height, CanvasTriangle out[MAX_GUARD_BAND_CLIPPED_TRIANGLES]) {
+	const float minX = -GUARD_BAND_MARGIN;
+	const float minY = -GUARD_BAND_MARGIN;
+	const float maxX = width + GUARD_BAND_MARGIN;
+	const float maxY = height + GUARD_BAND_MARGIN;
+	bool inside = true;
+	for (int i = 0; i < 3; i++) {
+		const CanvasPoint &point = triangle[i];
+		// written so that NaN coordinates count as outside
+		if (!(point.x >= minX && point.x <= maxX && point.y >= minY && point.y <= maxY)) inside = false;
+	}
+	if (inside) {
+		out[0] = triangle;
+		return 1;
+	}
+
+	// each of the four passes can add at most one vertex
+	CanvasPoint first[7], second[7];
+	for (int i = 0; i < 3; i++) first[i] = triangle[i];
+	int count = 3;
+	count = clipPolygon(first, count, second, [=](const CanvasPoint &p) { return p.x - minX; }, interpolateProjected);
+	count = clipPolygon(second, count, first, [=](const CanvasPoint &p) { return maxX - p.x; }, interpolateProjected);
+	count = clipPolygon(first, count, second, [=](const CanvasPoint &p) { return p.y - minY; }, interpolateProjected);
+	count = clipPolygon(second, count, first, [=](const CanvasPoint &p) { return maxY - p.y; }, interpolateProjected);
+	int triangles = 0;
+	for (int i = 1; i + 1 < count; i++) out[triangles++] = CanvasTriangle(first[0], first[i], first[i + 1]);
+	return triangles;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "CanvasTriangle.h"
+#include "ModelTriangle.h"
+
+// Sutherland-Hodgman clipping, run before projection (against the near plane) and after it (against a
+// guard band around the canvas), so the rasterisers only ever see geometry in front of the camera whose
+// size is bounded no matter where the camera is.
+
+// Anything further than this outside the canvas is clipped off; anything less is left to the rasteriser's
+// own bounding box clamp, which is far cheaper than clipping
+const float GUARD_BAND_MARGIN = 1024.0f;
+
+// Most triangles a single triangle can be split into by each clip
+const int MAX_NEAR_CLIPPED_TRIANGLES = 2;
+const int MAX_GUARD_BAND_CLIPPED_TRIANGLES = 5;
+
+// The plane (as normal and offset) that keeps points at least nearDistance along forward from the camera
+glm::vec4 nearPlane(glm::vec3 cameraPosition, glm::vec3 forward, float nearDistance);
+// Keeps the part of the triangle where dot(plane.xyz, point) + plane.w >= 0, interpolating texture points.
+// Returns how many triangles were written to out.
+int clipToPlane(const ModelTriangle &triangle, const glm::vec4 &plane, ModelTriangle out[MAX_NEAR_CLIPPED_TRIANGLES]);
+// Clips a projected triangle (whose depths hold 1/z) to the canvas plus GUARD_BAND_MARGIN on every side.
+// Depth is interpolated linearly and texture points perspective-correctly. Returns how many triangles were
+// written to out; a triangle already inside the guard band is copied through untouched.
+int clipToGuardBand(const CanvasTriangle &triangle, float width, float height, CanvasTriangle out[MAX_GUARD_BAND_CLIPPED_TRIANGLES]);
@@ -0,0 +1,118 @@
+#include "Culling.h"
+
+size_t CullStats::culled() const {
+	return backFacing + outsideFrustum;
+}
+
+CullStats &CullStats::operator+=(const CullStats &other) {
+	backFacing += other.backFacing;
+	outsideFrustum += other.outsideFrustum;
+	visible += other.visible;
+	culledObjects += other.culledObjects;
+	return *this;
+}
+
+bool CullStats::operator==(const CullStats &other) const {
+	return backFacing == other.backFacing && outsideFrustum == other.outsideFrustum && visible == other.visible &&
+	       culledObjects == other.culledObjects;
+}
+
+bool CullStats::operator!=(const CullStats &other) const {
+	return !(*this == other);
+}
+
+std::ostream &operator<<(std::ostream &os, const CullStats &stats) {
+	os << stats.visible << " visible, " << stats.backFacing << " back-facing, " << stats.outsideFrustum << " outside the frustum ("
+	   << stats.culledObjects << " whole objects)";
+	return os;
+}
+
+glm::vec3 faceNormal(const ModelTriangle &triangle) {
+	glm::vec3 normal = glm::cross(triangle.vertices[1] - triangle.vertices[0], triangle.vertices[2] - triangle.vertices[0]);
+	float length = glm::length(normal);
+	return length > 0.0f ? normal / length : glm::vec3(0.0f);
+}
+
+Frustum makeFrustum(glm::vec3 cameraPosition, glm::vec3 right, glm::vec3 up, glm::vec3 forward,
+                    float tanHalfWidth, float tanHalfHeight, float nearDistance) {
+	Frustum frustum;
+	// the side planes all pass through the camera, leaning out from the forward axis
+	glm::vec3 normals[4] = {
+			forward * tanHalfWidth + right,
+			forward * tanHalfWidth - right,
+			forward * tanHalfHeight + up,
+			forward * tanHalfHeight - up
+	};
+	for (int i = 0; i < 4; i++) frustum.planes[i] = glm::vec4(normals[i], -glm::dot(normals[i], cameraPosition));
+	frustum.planes[4] = glm::vec4(forward, -glm::dot(forward, cameraPosition) - nearDistance);
+	return frustum;
+}
+
+bool isBackFacing(const ModelTriangle &triangle, glm::vec3 cameraPosition) {
+	return glm::dot(triangle.normal, cameraPosition - triangle.vertices[0]) <= 0.0f;
+}
+
+namespace {
+
+bool outsideAnyPlane(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2, const Frustum &frustum) {
+	for (const glm::vec4 &plane : frustum.planes) {
+		glm::vec3 normal(plane);
+		if (glm::dot(normal, v0) + plane.w < 0.0f && glm::dot(normal, v1) + plane.w < 0.0f && glm::dot(normal, v2) + plane.w < 0.0f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+bool isOutsideFrustum(const ModelTriangle &triangle, const Frustum &frustum) {
+	return outsideAnyPlane(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], frustum);
+}
+
+CullStats cullTriangles(const std::vector<ModelTriangle> &triangles, glm::vec3 cameraPosition, const Frustum &frustum,
+                        std::vector<const ModelTriangle *> &visible) {
+	CullStats stats;
+	visible.clear();
+	for (const ModelTriangle &triangle : triangles) {
+		// the back-face test is a single dot product, so it goes first
+		if (isBackFacing(triangle, cameraPosition)) stats.backFacing++;
+		else if (isOutsideFrustum(triangle, frustum)) stats.outsideFrustum++;
+		else visible.push_back(&triangle);
+	}
+	stats.visible = visible.size();
+	return stats;
+}
+
+bool isOutsideFrustum(glm::vec3 boundsMin, glm::vec3 boundsMax, const Frustum &frustum) {
+	for (const glm::vec4 &plane : frustum.planes) {
+		// the corner furthest along the plane's normal is the last to leave
+		glm::vec3 furthest(plane.x >= 0.0f ? boundsMax.x : boundsMin.x, plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+		                   plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+		if (!(glm::dot(glm::vec3(plane), furthest) + plane.w >= 0.0f)) return true;
+	}
+	return false;
+}
+
+CullStats cullTriangles(const Mesh &mesh, glm::vec3 cameraPosition, const Frustum &frustum, std::vector<uint32_t> &visible) {
+	MeshPart whole{"", 0, uint32_t(mesh.triangleCount()), 0, uint32_t(mesh.positions.size()), glm::vec3(), glm::vec3()};
+	return cullTriangles(mesh, whole, cameraPosition, frustum, visible);
+}
+
+CullStats cullTriangles(const Mesh &mesh, const MeshPart &part, glm::vec3 cameraPosition, const Frustum &frustum, std::vector<uint32_t> &visible) {
+	CullStats stats;
+	visible.clear();
+	const uint32_t *indices = mesh.indices.data() + size_t(part.firstTriangle) * 3;
+	for (uint32_t t = part.firstTriangle; t < part.firstTriangle + part.triangleCount; t++, indices += 3) {
+		const glm::vec3 &v0 = mesh.positions[indices[0]];
+		const glm::vec3 &v1 = mesh.positions[indices[1]];
+		const glm::vec3 &v2 = mesh.positions[indices[2]];
+		// only the sign matters, so the normal needn't be unit length
+		glm::vec3 normal = glm::cross(v1 - v0, v2 - v0);
+		if (glm::dot(normal, cameraPosition - v0) <= 0.0f) stats.backFacing++;
+		else if (outsideAnyPlane(v0, v1, v2, frustum)) stats.outsideFrustum++;
+		else visible.push_back(t);
+	}
+	stats.visible = visible.size();
+	return stats;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.h"
+#include "ModelTriangle.h"
+
+// Planes bounding what the camera can see, each kept where dot(plane.xyz, point) + plane.w >= 0.
+// There is no far plane, as the projection doesn't have one either.
+struct Frustum {
+	static const int PLANE_COUNT = 5;
+	glm::vec4 planes[PLANE_COUNT];
+};
+
+struct CullStats {
+	size_t backFacing{};
+	size_t outsideFrustum{};
+	size_t visible{};
+	// whole objects found to be outside the frustum from their bounds (their triangles count as outsideFrustum)
+	size_t culledObjects{};
+
+	size_t culled() const;
+	CullStats &operator+=(const CullStats &other);
+	bool operator==(const CullStats &other) const;
+	bool operator!=(const CullStats &other) const;
+	friend std::ostream &operator<<(std::ostream &os, const CullStats &stats);
+};
+
+// The unit normal of the triangle's front face (the side its vertices wind anticlockwise around),
+// or zero if it has no area
+glm::vec3 faceNormal(const ModelTriangle &triangle);
+// tanHalfWidth and tanHalfHeight are how far the edges of the view are off the forward axis per unit of
+// distance along it
+Frustum makeFrustum(glm::vec3 cameraPosition, glm::vec3 right, glm::vec3 up, glm::vec3 forward,
+                    float tanHalfWidth, float tanHalfHeight, float nearDistance);
+// Relies on triangle.normal having been filled in (see faceNormal)
+bool isBackFacing(const ModelTriangle &triangle, glm::vec3 cameraPosition);
+// Only true when the whole triangle is outside one plane, so a few triangles near the corners of the
+// frustum survive without being visible
+bool isOutsideFrustum(const ModelTriangle &triangle, const Frustum &frustum);
+// Whether the box is wholly outside one of the planes (an empty box, with min above max, always is)
+bool isOutsideFrustum(glm::vec3 boundsMin, glm::vec3 boundsMax, const Frustum &frustum);
+// Replaces visible with the triangles that survive both tests, and counts what happened to the rest
+CullStats cullTriangles(const std::vector<ModelTriangle> &triangles, glm::vec3 cameraPosition, const Frustum &frustum,
+                        std::vector<const ModelTriangle *> &visible);
+// As above, for an indexed mesh: visible gets the indices of the surviving triangles. The back-face test
+// works from the vertices alone, so the mesh needs no stored normals.
+CullStats cullTriangles(const Mesh &mesh, glm::vec3 cameraPosition, const Frustum &frustum, std::vector<uint32_t> &visible);
+// The same for just one part of the mesh
+CullStats cullTriangles(const Mesh &mesh, const MeshPart &part, glm::vec3 cameraPosition, const Frustum &frustum, std::vector<uint32_t> &visible);
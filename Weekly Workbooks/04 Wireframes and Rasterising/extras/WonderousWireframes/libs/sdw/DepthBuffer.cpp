@@ -0,0 +1,73 @@
+#include "DepthBuffer.h"
+#include <algorithm>
+#include "SimdLanes.h"
+
+DepthBuffer::DepthBuffer() : width(0), height(0), stride(0) {}
+
+DepthBuffer::DepthBuffer(size_t w, size_t h) : width(w), height(h) {
+	size_t across = (w + TILE_SIZE - 1) / TILE_SIZE;
+	size_t down = (h + TILE_SIZE - 1) / TILE_SIZE;
+	stride = across * TILE_SIZE;
+	depths.resize(stride * down * TILE_SIZE, 0.0f);
+	tileFurthest.resize(across * down, 0.0f);
+	tileCleared.resize(across * down, 0);
+}
+
+void DepthBuffer::clear() {
+	std::fill(tileFurthest.begin(), tileFurthest.end(), 0.0f);
+	std::fill(tileCleared.begin(), tileCleared.end(), 1);
+}
+
+float DepthBuffer::getDepth(size_t x, size_t y) const {
+	if (tileCleared[(y / TILE_SIZE) * tilesAcross() + (x / TILE_SIZE)]) return 0.0f;
+	return depths[y * stride + x];
+}
+
+void DepthBuffer::prepareTile(size_t tileX, size_t tileY) {
+	size_t tile = tileY * tilesAcross() + tileX;
+	if (!tileCleared[tile]) return;
+	for (size_t y = tileY * TILE_SIZE; y < (tileY + 1) * TILE_SIZE; y++) {
+		float *row = rowPointer(y) + tileX * TILE_SIZE;
+		std::fill(row, row + TILE_SIZE, 0.0f);
+	}
+	tileCleared[tile] = 0;
+}
+
+bool DepthBuffer::isTileOccluded(size_t tileX, size_t tileY, float nearestDepth) const {
+	return nearestDepth <= tileFurthest[tileY * tilesAcross() + tileX];
+}
+
+void DepthBuffer::updateTile(size_t tileX, size_t tileY) {
+	// the padding beyond the window edge is never drawn to, so leave it out or it would pin the tile at 0
+	size_t firstX = tileX * TILE_SIZE;
+	size_t lastX = std::min(firstX + TILE_SIZE, width);
+	size_t lastY = std::min((tileY + 1) * TILE_SIZE, height);
+	float furthest;
+	if (lastX - firstX == size_t(TILE_SIZE)) {
+		lanes::Floats smallest = lanes::load(rowPointer(tileY * TILE_SIZE) + firstX);
+		for (size_t y = tileY * TILE_SIZE; y < lastY; y++) {
+			const float *row = rowPointer(y) + firstX;
+			for (int x = 0; x < TILE_SIZE; x += lanes::LANE_COUNT) smallest = lanes::minimum(smallest, lanes::load(row + x));
+		}
+		furthest = lanes::horizontalMinimum(smallest);
+	} else {
+		furthest = depths[tileY * TILE_SIZE * stride + firstX];
+		for (size_t y = tileY * TILE_SIZE; y < lastY; y++) {
+			const float *row = rowPointer(y);
+			furthest = std::min(furthest, *std::min_element(row + firstX, row + lastX));
+		}
+	}
+	tileFurthest[tileY * tilesAcross() + tileX] = furthest;
+}
+
+float *DepthBuffer::rowPointer(size_t y) {
+	return depths.data() + (y * stride);
+}
+
+size_t DepthBuffer::tilesAcross() const {
+	return stride / TILE_SIZE;
+}
+
+size_t DepthBuffer::tilesDown() const {
+	return tileFurthest.empty() ? 0 : tileFurthest.size() / tilesAcross();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-pixel 1/z buffer the same size as the DrawingWindow it sits alongside. Larger values are nearer,
+// and 0 means nothing has been drawn there yet. On top of the pixels it keeps a coarse level holding the
+// smallest (i.e. furthest) 1/z of every TILE_SIZE x TILE_SIZE tile, so that a triangle which is behind
+// everything already drawn in a tile can be skipped for that whole tile without touching any pixels.
+class DepthBuffer {
+public:
+	static const int TILE_SIZE = 8;
+
+	size_t width;
+	size_t height;
+
+	DepthBuffer();
+	DepthBuffer(size_t w, size_t h);
+	// Only resets the coarse level; each tile's pixels are wiped the first time it is drawn to afterwards
+	void clear();
+	float getDepth(size_t x, size_t y) const;
+
+	// Must be called before writing to any pixel of the tile
+	void prepareTile(size_t tileX, size_t tileY);
+	// True if a surface no nearer than nearestDepth is hidden everywhere in the tile
+	bool isTileOccluded(size_t tileX, size_t tileY, float nearestDepth) const;
+	// Recalculates the tile's entry in the coarse level after its pixels have been written
+	void updateTile(size_t tileX, size_t tileY);
+	// Rows are padded out to whole tiles, so a full tile row can always be read or written
+	float *rowPointer(size_t y);
+	size_t tilesAcross() const;
+	size_t tilesDown() const;
+
+private:
+	size_t stride;
+	std::vector<float> depths;
+	std::vector<float> tileFurthest;
+	std::vector<uint8_t> tileCleared;
+};
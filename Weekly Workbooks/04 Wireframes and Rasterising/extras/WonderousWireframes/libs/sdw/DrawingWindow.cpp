@@ -1,18 +1,17 @@
-#include <array>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include "DrawingWindow.h"
-// On some platforms you may need to include <cstring> (if you compiler can't find memset !)
+#include "FrameSink.h"
 
-DrawingWindow::DrawingWindow() {}
+namespace {
 
-DrawingWindow::DrawingWindow(int w, int h, bool fullscreen) : width(w), height(h), pixelBuffer(w * h) {
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) printMessageAndQuit("Could not initialise SDL: ", SDL_GetError());
-	uint32_t flags = SDL_WINDOW_OPENGL;
-	if (fullscreen) flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
-	int ANYWHERE = SDL_WINDOWPOS_UNDEFINED;
-	window = SDL_CreateWindow("COMS30020", ANYWHERE, ANYWHERE, width, height, flags);
-	if (!window) printMessageAndQuit("Could not set video mode: ", SDL_GetError());
+void createRenderer(SDL_Window *window, size_t width, size_t height, SDL_Renderer *&renderer, SDL_Texture *&texture) {
 	// Set rendering to software (hardware acceleration doesn't work on all platforms)
-	flags = SDL_RENDERER_SOFTWARE;
+	uint32_t flags = SDL_RENDERER_SOFTWARE;
 	// You could try hardware acceleration if you like - by uncommenting the below line
 	// flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
 	renderer = SDL_CreateRenderer(window, -1, flags);
@@ -20,45 +19,179 @@ DrawingWindow::DrawingWindow(int w, int h, bool fullscreen) : width(w), height(h
 	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 	SDL_RenderSetLogicalSize(renderer, width, height);
 	int PIXELFORMAT = SDL_PIXELFORMAT_ARGB8888;
-	texture = SDL_CreateTexture(renderer, PIXELFORMAT, SDL_TEXTUREACCESS_STATIC, width, height);
+	// Streaming, so frames can be written straight into the texture's memory rather than copied in by SDL
+	texture = SDL_CreateTexture(renderer, PIXELFORMAT, SDL_TEXTUREACCESS_STREAMING, width, height);
 	if (!texture) printMessageAndQuit("Could not allocate texture: ", SDL_GetError());
 }
 
-void DrawingWindow::renderFrame() {
-	SDL_UpdateTexture(texture, nullptr, pixelBuffer.data(), width * sizeof(uint32_t));
+// Beyond this many updates in a row the run loop drops the backlog, rather than falling further and further
+// behind when updating takes longer than the time step
+const int MAX_UPDATES_PER_FRAME = 5;
+
+bool isQuitEvent(const SDL_Event &event) {
+	if (event.type == SDL_QUIT) return true;
+	if ((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_ESCAPE)) return true;
+	return (event.type == SDL_WINDOWEVENT) && (event.window.event == SDL_WINDOWEVENT_CLOSE);
+}
+
+double secondsNow() {
+	return double(SDL_GetPerformanceCounter()) / double(SDL_GetPerformanceFrequency());
+}
+
+void presentTexture(SDL_Renderer *renderer, SDL_Texture *texture) {
 	SDL_RenderClear(renderer);
 	SDL_RenderCopy(renderer, texture, nullptr, nullptr);
 	SDL_RenderPresent(renderer);
 }
 
-void DrawingWindow::saveBMP(const std::string &filename) const {
-	auto surface = SDL_CreateRGBSurfaceFrom((void *) pixelBuffer.data(), width, height, 32,
-	                                        width * sizeof(uint32_t),
-	                                        0xFF << 16, 0xFF << 8, 0xFF << 0, 0xFF << 24);
-	SDL_SaveBMP(surface, filename.c_str());
 }
 
-void DrawingWindow::savePPM(const std::string &filename) const {
-	std::ofstream outputStream(filename, std::ofstream::out);
-	outputStream << "P6\n";
-	outputStream << width << " " << height << "\n";
-	outputStream << "255\n";
-
-	for (size_t i = 0; i < width * height; i++) {
-		std::array<char, 3> rgb {{
-				static_cast<char> ((pixelBuffer[i] >> 16) & 0xFF),
-				static_cast<char> ((pixelBuffer[i] >> 8) & 0xFF),
-				static_cast<char> ((pixelBuffer[i] >> 0) & 0xFF)
-		}};
-		outputStream.write(rgb.data(), 3);
+// Owns the SDL renderer on a thread of its own, uploading and presenting each frame it is handed while the
+// drawing thread gets on with the next one
+class FramePresenter {
+public:
+	FramePresenter(SDL_Window *presentedWindow, size_t w, size_t h) :
+			window(presentedWindow), width(w), height(h), spare(w * h), pending(nullptr), presenting(false), ready(false),
+			stopping(false) {
+		thread = std::thread(&FramePresenter::run, this);
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [this] { return ready; });
+	}
+
+	~FramePresenter() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		wake.notify_one();
+		thread.join();
+	}
+
+	// Waits for the previous frame to finish presenting, then hands this one over. The frame must be left
+	// alone until the next call returns.
+	void present(const uint32_t *frame) {
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [this] { return !presenting; });
+		pending = frame;
+		presenting = true;
+		wake.notify_one();
+	}
+
+	uint32_t *spareBuffer() {
+		return spare.data();
+	}
+
+private:
+	SDL_Window *window;
+	size_t width;
+	size_t height;
+	std::vector<uint32_t> spare;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+	const uint32_t *pending;
+	bool presenting;
+	bool ready;
+	bool stopping;
+	std::thread thread;
+
+	void run() {
+		SDL_Renderer *renderer;
+		SDL_Texture *texture;
+		createRenderer(window, width, height, renderer, texture);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			ready = true;
+		}
+		idle.notify_all();
+		while (true) {
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return pending != nullptr || stopping; });
+			if (pending == nullptr) break;
+			const uint32_t *frame = pending;
+			pending = nullptr;
+			lock.unlock();
+
+			void *locked;
+			int lockedPitch;
+			if (SDL_LockTexture(texture, nullptr, &locked, &lockedPitch) == 0) {
+				for (size_t y = 0; y < height; y++) {
+					std::memcpy(static_cast<uint8_t *>(locked) + y * lockedPitch, frame + y * width, width * sizeof(uint32_t));
+				}
+				SDL_UnlockTexture(texture);
+			}
+			presentTexture(renderer, texture);
+
+			lock.lock();
+			presenting = false;
+			idle.notify_all();
+		}
+		SDL_DestroyTexture(texture);
+		SDL_DestroyRenderer(renderer);
+	}
+};
+
+DrawingWindow::DrawingWindow() : window(nullptr), renderer(nullptr), texture(nullptr), presentMode(PresentMode::DIRECT), dirty(true),
+		frameSink(nullptr) {}
+
+DrawingWindow::DrawingWindow(int w, int h, bool fullscreen, PresentMode mode) :
+		Framebuffer(w, h), renderer(nullptr), texture(nullptr), presentMode(mode), dirty(true), frameSink(nullptr) {
+	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) printMessageAndQuit("Could not initialise SDL: ", SDL_GetError());
+	uint32_t flags = SDL_WINDOW_OPENGL;
+	if (fullscreen) flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+	int ANYWHERE = SDL_WINDOWPOS_UNDEFINED;
+	window = SDL_CreateWindow("COMS30020", ANYWHERE, ANYWHERE, width, height, flags);
+	if (!window) printMessageAndQuit("Could not set video mode: ", SDL_GetError());
+	if (presentMode == PresentMode::THREADED) {
+		presenter.reset(new FramePresenter(window, width, height));
+	} else {
+		createRenderer(window, width, height, renderer, texture);
+		// frames are drawn straight into the texture, so the framebuffer's own pixels would never be used
+		std::vector<uint32_t>().swap(pixelBuffer);
+		lockTexture();
+	}
+}
+
+DrawingWindow::DrawingWindow(DrawingWindow &&other) = default;
+
+DrawingWindow &DrawingWindow::operator=(DrawingWindow &&other) = default;
+
+DrawingWindow::~DrawingWindow() = default;
+
+void DrawingWindow::lockTexture() {
+	void *locked;
+	int lockedPitch;
+	if (SDL_LockTexture(texture, nullptr, &locked, &lockedPitch) != 0) printMessageAndQuit("Could not lock texture: ", SDL_GetError());
+	pixels = static_cast<uint32_t *>(locked);
+	pitch = lockedPitch / sizeof(uint32_t);
+}
+
+void DrawingWindow::renderFrame() {
+	if (frameSink) frameSink->submit(view());
+	if (presentMode == PresentMode::THREADED) {
+		presenter->present(pixels);
+		// present() only returns once the presenter is done with the other buffer, so the next frame goes there
+		pixels = pixels == pixelBuffer.data() ? presenter->spareBuffer() : pixelBuffer.data();
+	} else {
+		SDL_UnlockTexture(texture);
+		presentTexture(renderer, texture);
+		lockTexture();
 	}
-	outputStream.close();
+}
+
+void DrawingWindow::recordTo(FrameSink *sink) {
+	frameSink = sink;
 }
 
 void DrawingWindow::exitCleanly()
 {
-	SDL_DestroyTexture(texture);
-	SDL_DestroyRenderer(renderer);
+	// shutting the presenter down waits for its last frame and destroys its renderer and texture
+	presenter.reset();
+	if (texture) {
+		SDL_UnlockTexture(texture);
+		SDL_DestroyTexture(texture);
+	}
+	if (renderer) SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 	printMessageAndQuit("Exiting", nullptr);
@@ -66,33 +199,67 @@ void DrawingWindow::exitCleanly()
 
 bool DrawingWindow::pollForInputEvents(SDL_Event &event) {
 	if (SDL_PollEvent(&event)) {
-		if (event.type == SDL_QUIT) exitCleanly();
-		else if ((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_ESCAPE)) exitCleanly();
-		else if ((event.type == SDL_WINDOWEVENT) && (event.window.event == SDL_WINDOWEVENT_CLOSE)) exitCleanly();
-		SDL_Event dummy;
-		// Clear the event queue by getting all available events
-		// This seems like bad practice (because it will skip some events) however preventing backlog is paramount !
-		while (SDL_PollEvent(&dummy));
+		if (isQuitEvent(event)) exitCleanly();
 		return true;
 	}
 	return false;
 }
 
-void DrawingWindow::setPixelColour(size_t x, size_t y, uint32_t colour) {
-	if ((x >= width) || (y >= height)) {
-		std::cout << x << "," << y << " not on visible screen area" << std::endl;
-	} else pixelBuffer[(y * width) + x] = colour;
-}
+void DrawingWindow::run(const std::function<bool(const SDL_Event &)> &handleEvent, const std::function<bool(double)> &update,
+                        const std::function<void()> &draw, const RunLoopSettings &settings) {
+	const double updateStep = 1.0 / settings.updatesPerSecond;
+	double frameInterval = settings.maxFramesPerSecond > 0.0 ? 1.0 / settings.maxFramesPerSecond : 0.0;
+	// a recording holds one frame per interval of real time, so drawing any faster would only speed it up
+	const double recordInterval = frameSink ? 1.0 / frameSink->framesPerSecond() : HUGE_VAL;
+	if (frameSink) frameInterval = std::max(frameInterval, recordInterval);
+	double nextUpdate = secondsNow();
+	double nextFrame = nextUpdate;
+	// nothing to repeat until the first frame is drawn
+	double nextRecord = HUGE_VAL;
+	while (true) {
+		// Sleep until an event arrives, or until there's an update or a (dirty) frame due
+		double wakeAt = HUGE_VAL;
+		if (update) wakeAt = nextUpdate;
+		if (dirty) wakeAt = std::min(wakeAt, nextFrame);
+		if (frameSink) wakeAt = std::min(wakeAt, nextRecord);
+		SDL_Event event;
+		bool received;
+		if (wakeAt == HUGE_VAL) {
+			received = SDL_WaitEvent(&event) != 0;
+		} else {
+			int timeout = int(std::ceil((wakeAt - secondsNow()) * 1000.0));
+			received = timeout > 0 ? SDL_WaitEventTimeout(&event, timeout) != 0 : SDL_PollEvent(&event) != 0;
+		}
+		// then handle everything that has queued up, so no key press is lost
+		while (received) {
+			if (isQuitEvent(event)) exitCleanly();
+			if (handleEvent && handleEvent(event)) dirty = true;
+			received = SDL_PollEvent(&event) != 0;
+		}
 
-uint32_t DrawingWindow::getPixelColour(size_t x, size_t y) {
-	if ((x >= width) || (y >= height)) {
-		std::cout << x << "," << y << " not on visible screen area" << std::endl;
-		return -1;
-	} else return pixelBuffer[(y * width) + x];
+		double now = secondsNow();
+		if (update) {
+			for (int updates = 0; now >= nextUpdate && updates < MAX_UPDATES_PER_FRAME; updates++) {
+				if (update(updateStep)) dirty = true;
+				nextUpdate += updateStep;
+			}
+			if (now >= nextUpdate) nextUpdate = now + updateStep;
+		}
+		if (dirty && now >= nextFrame) {
+			dirty = false;
+			draw();
+			renderFrame();
+			nextFrame = now + frameInterval;
+			nextRecord = now + recordInterval;
+		} else if (frameSink) {
+			// idle, so the recording gets the frame still on screen for every interval that has gone by
+			for (; now >= nextRecord; nextRecord += recordInterval) frameSink->repeatLast();
+		}
+	}
 }
 
-void DrawingWindow::clearPixels() {
-	std::fill(pixelBuffer.begin(), pixelBuffer.end(), 0);
+void DrawingWindow::markDirty() {
+	dirty = true;
 }
 
 void printMessageAndQuit(const std::string &message, const char *error) {
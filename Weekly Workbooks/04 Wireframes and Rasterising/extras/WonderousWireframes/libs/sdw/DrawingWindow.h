@@ -2,32 +2,75 @@
 
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <vector>
+#include "Framebuffer.h"
 #include "SDL.h"
 
-class DrawingWindow {
+enum class PresentMode {
+	// Draw straight into the locked streaming texture, so presenting never copies the frame.
+	// Like all SDL rendering this happens on the calling thread.
+	DIRECT,
+	// Draw into one of two buffers while a presenter thread uploads and presents the other, so the copy and
+	// present overlap with drawing the next frame. The presenter thread owns the SDL renderer, which SDL
+	// only documents as working from the main thread: it happens to work with some drivers on some
+	// platforms (never macOS), so this is only for trying out where it does.
+	THREADED
+};
 
-public:
-	size_t width;
-	size_t height;
+class FramePresenter;
+class FrameSink;
+
+struct RunLoopSettings {
+	// how often the update callback is called, with a fixed time step of 1 / updatesPerSecond
+	double updatesPerSecond{60.0};
+	// frames are presented at most this often (0 for no limit)
+	double maxFramesPerSecond{60.0};
+};
+
+// Presents a Framebuffer's pixels in an SDL window. Everything to do with the pixels themselves lives in
+// Framebuffer, so code that only draws can take one of those and run without a display.
+// Either way of presenting hands back a different buffer (or freshly locked texture memory) after each
+// renderFrame, so each frame should be drawn in full rather than on top of the last one, and anything that
+// wants what is on screen (a screenshot, say) needs its own copy of the frame from before renderFrame.
+class DrawingWindow : public Framebuffer {
 
 private:
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	SDL_Texture *texture;
-	std::vector<uint32_t> pixelBuffer;
+	PresentMode presentMode;
+	std::unique_ptr<FramePresenter> presenter;
+	bool dirty;
+	FrameSink *frameSink;
+
+	void lockTexture();
 
 public:
 	DrawingWindow();
-	DrawingWindow(int w, int h, bool fullscreen);
+	DrawingWindow(int w, int h, bool fullscreen, PresentMode mode = PresentMode::DIRECT);
+	DrawingWindow(DrawingWindow &&other);
+	DrawingWindow &operator=(DrawingWindow &&other);
+	~DrawingWindow();
 	void renderFrame();
-	void savePPM(const std::string &filename) const;
-	void saveBMP(const std::string &filename) const;
+	// Every frame renderFrame presents is also submitted to sink (which must outlive the window, or be
+	// replaced with nullptr first). While run is running, the recording keeps to the sink's frame rate:
+	// frames are drawn no more often than that, and the last one is repeated for as long as nothing changes.
+	void recordTo(FrameSink *sink);
+	// Takes the next queued event, if there is one (quitting if it asks to). Call it until it returns false,
+	// as each call only takes a single event.
 	bool pollForInputEvents(SDL_Event &event);
+	// Runs until the window is closed, sleeping whenever there is nothing to do:
+	//  - every event is passed to handleEvent, which returns whether it changed what is on screen
+	//  - update (if given) is called at a fixed rate with the time step, returning whether anything changed
+	//  - draw is called, and the frame presented, only when something has changed, and no faster than
+	//    settings.maxFramesPerSecond
+	void run(const std::function<bool(const SDL_Event &)> &handleEvent, const std::function<bool(double)> &update,
+	         const std::function<void()> &draw, const RunLoopSettings &settings = RunLoopSettings());
+	// Makes run redraw at the next opportunity, for changes made outside of its callbacks
+	void markDirty();
 	void exitCleanly();
-	void setPixelColour(size_t x, size_t y, uint32_t colour);
-	uint32_t getPixelColour(size_t x, size_t y);
-	void clearPixels();
 };
 
 void printMessageAndQuit(const std::string &message, const char *error);
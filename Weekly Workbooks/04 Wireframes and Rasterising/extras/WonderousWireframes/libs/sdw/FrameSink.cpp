@@ -0,0 +1,111 @@
+#include "FrameSink.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include "ImageEncoding.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+FrameSink::FrameSink(const std::string &path, StreamFormat streamFormat, size_t w, size_t h, int framesPerSecond, size_t ringSize) :
+		file(nullptr), ownsFile(path != "-"), format(streamFormat), width(w), height(h), frameRate(framesPerSecond),
+		ring(std::max<size_t>(ringSize, 1), std::vector<uint32_t>(w * h)), first(0), count(0), lastSlot(0), submitted(false),
+		written(0), stopping(false) {
+	if (ownsFile) {
+		file = std::fopen(path.c_str(), "wb");
+		if (!file) std::cerr << "Could not open " << path << " for writing" << std::endl;
+	} else {
+#ifdef _WIN32
+		// stdout would otherwise turn every 0x0A byte into 0x0D 0x0A
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		file = stdout;
+	}
+	if (file && format == StreamFormat::Y4M) {
+		std::fprintf(file, "YUV4MPEG2 W%zu H%zu F%d:1 Ip A1:1 C420jpeg\n", width, height, framesPerSecond);
+	}
+	thread = std::thread(&FrameSink::run, this);
+}
+
+FrameSink::~FrameSink() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	frameReady.notify_one();
+	thread.join();
+	if (file && ownsFile) std::fclose(file);
+	else if (file) std::fflush(file);
+}
+
+bool FrameSink::isOpen() const {
+	return file != nullptr;
+}
+
+void FrameSink::submit(const FramebufferView &frame) {
+	assert(frame.width == width && frame.height == height);
+	if (!file) return;
+	std::unique_lock<std::mutex> lock(mutex);
+	slotFree.wait(lock, [this] { return count < ring.size(); });
+	size_t slot = (first + count) % ring.size();
+	// the writer never touches a slot that hasn't been counted yet, so the copy can happen unlocked
+	lock.unlock();
+	FramebufferView(ring[slot].data(), width, height, width).blit(0, 0, frame);
+	lock.lock();
+	count++;
+	lastSlot = slot;
+	submitted = true;
+	frameReady.notify_one();
+}
+
+void FrameSink::repeatLast() {
+	if (!file || !submitted) return;
+	std::unique_lock<std::mutex> lock(mutex);
+	slotFree.wait(lock, [this] { return count < ring.size(); });
+	size_t slot = (first + count) % ring.size();
+	// the writer only ever reads slots, so the last frame's can be copied from while it's being written out
+	lock.unlock();
+	if (slot != lastSlot) ring[slot] = ring[lastSlot];
+	lock.lock();
+	count++;
+	lastSlot = slot;
+	frameReady.notify_one();
+}
+
+int FrameSink::framesPerSecond() const {
+	return frameRate;
+}
+
+size_t FrameSink::framesWritten() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return written;
+}
+
+void FrameSink::run() {
+	std::vector<uint8_t> encoded;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		frameReady.wait(lock, [this] { return count > 0 || stopping; });
+		if (count == 0) break;
+		std::vector<uint32_t> &slot = ring[first];
+		lock.unlock();
+
+		FramebufferView frame(slot.data(), width, height, width);
+		if (format == StreamFormat::Y4M) encodeY4MFrame(frame, encoded);
+		else encodePPM(frame, encoded);
+		bool ok = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+		if (!ok) std::cerr << "Frame stream write failed" << std::endl;
+
+		lock.lock();
+		first = (first + 1) % ring.size();
+		count--;
+		written++;
+		slotFree.notify_one();
+	}
+}
+
+StreamFormat streamFormatFor(const std::string &path) {
+	bool y4m = path == "-" || (path.size() >= 4 && path.compare(path.size() - 4, 4, ".y4m") == 0);
+	return y4m ? StreamFormat::Y4M : StreamFormat::PPM;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FramebufferView.h"
+
+enum class StreamFormat {
+	// YUV4MPEG2, which ffmpeg and most encoders read directly
+	Y4M,
+	// one binary PPM after another (ffmpeg's image2pipe)
+	PPM
+};
+
+// Appends frames to a single stream (a file, or stdout for piping straight into an encoder) so animations
+// can be rendered without an intermediate file per frame. Frames are copied into a fixed ring of buffers
+// and written by a background thread; when the ring is full, submit waits for the writer to catch up.
+class FrameSink {
+public:
+	// path "-" writes to stdout. Every frame must be width x height.
+	FrameSink(const std::string &path, StreamFormat streamFormat, size_t w, size_t h, int framesPerSecond, size_t ringSize = 4);
+	// Writes any frames still in the ring, then closes the stream
+	~FrameSink();
+	FrameSink(const FrameSink &) = delete;
+	FrameSink &operator=(const FrameSink &) = delete;
+
+	bool isOpen() const;
+	// Copies the frame into the ring. Frames must all be submitted from the same thread.
+	void submit(const FramebufferView &frame);
+	// Submits the last frame again (if there has been one), for a stream that keeps time while nothing changes
+	void repeatLast();
+	int framesPerSecond() const;
+	size_t framesWritten() const;
+
+private:
+	FILE *file;
+	bool ownsFile;
+	StreamFormat format;
+	size_t width;
+	size_t height;
+	int frameRate;
+	std::vector<std::vector<uint32_t>> ring;
+	// frames are written from ring[first] onwards, and there are count of them waiting
+	size_t first;
+	size_t count;
+	// where the last frame submitted went, which the writer leaves as it is until the slot is reused
+	size_t lastSlot;
+	bool submitted;
+	size_t written;
+	bool stopping;
+	mutable std::mutex mutex;
+	std::condition_variable frameReady;
+	std::condition_variable slotFree;
+	std::thread thread;
+
+	void run();
+};
+
+// Y4M for "-" and names ending in .y4m, a PPM stream otherwise
+StreamFormat streamFormatFor(const std::string &path);
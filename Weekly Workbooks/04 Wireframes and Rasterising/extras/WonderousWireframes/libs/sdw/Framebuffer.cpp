@@ -0,0 +1,67 @@
+#include <iostream>
+#include "Framebuffer.h"
+#include "ImageEncoding.h"
+
+Framebuffer::Framebuffer() : width(0), height(0), pixels(nullptr), pitch(0) {}
+
+Framebuffer::Framebuffer(int w, int h) : width(w), height(h), pixelBuffer(w * h), pixels(pixelBuffer.data()), pitch(w) {}
+
+Framebuffer::Framebuffer(const Framebuffer &other) : width(other.width), height(other.height), pixelBuffer(other.width * other.height),
+		pixels(pixelBuffer.data()), pitch(other.width) {
+	if (other.pixels) view().blit(0, 0, other.pixels, width, height, other.pitch);
+}
+
+Framebuffer &Framebuffer::operator=(const Framebuffer &other) {
+	if (this != &other) *this = Framebuffer(other);
+	return *this;
+}
+
+void Framebuffer::savePPM(const std::string &filename) const {
+	std::vector<uint8_t> encoded;
+	encodePPM(FramebufferView(pixels, width, height, pitch), encoded);
+	if (!writeFile(filename, encoded)) std::cout << "Could not write " << filename << std::endl;
+}
+
+void Framebuffer::saveBMP(const std::string &filename) const {
+	std::vector<uint8_t> encoded;
+	encodeBMP(FramebufferView(pixels, width, height, pitch), encoded);
+	if (!writeFile(filename, encoded)) std::cout << "Could not write " << filename << std::endl;
+}
+
+void Framebuffer::setPixelColour(size_t x, size_t y, uint32_t colour) {
+	if ((x >= width) || (y >= height)) {
+		// '\n' rather than std::endl, as flushing for every stray pixel grinds rendering to a halt
+		std::cout << x << "," << y << " not on visible screen area" << '\n';
+	} else pixels[(y * pitch) + x] = colour;
+}
+
+uint32_t Framebuffer::getPixelColour(size_t x, size_t y) {
+	if ((x >= width) || (y >= height)) {
+		std::cout << x << "," << y << " not on visible screen area" << std::endl;
+		return -1;
+	} else return pixels[(y * pitch) + x];
+}
+
+FramebufferView Framebuffer::view() {
+	return FramebufferView(pixels, width, height, pitch);
+}
+
+uint32_t *Framebuffer::rowPointer(size_t y) {
+	return view().row(y);
+}
+
+size_t Framebuffer::stride() const {
+	return pitch;
+}
+
+void Framebuffer::fillSpan(size_t y, size_t x0, size_t x1, uint32_t colour) {
+	view().fillSpan(y, x0, x1, colour);
+}
+
+void Framebuffer::blit(size_t x, size_t y, const uint32_t *source, size_t sourceWidth, size_t sourceHeight, size_t sourceStride) {
+	view().blit(x, y, source, sourceWidth, sourceHeight, sourceStride);
+}
+
+void Framebuffer::clearPixels() {
+	view().fill(0);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FramebufferView.h"
+
+// An off-screen block of ARGB8888 pixels with the same pixel API as DrawingWindow, but no SDL behind it,
+// so batch renders can run on machines with no display and go straight to savePPM / saveBMP.
+// DrawingWindow builds on this to present the pixels in a window.
+class Framebuffer {
+
+public:
+	size_t width;
+	size_t height;
+
+protected:
+	std::vector<uint32_t> pixelBuffer;
+	// The pixels currently being drawn to, pitch pixels from one row to the next. These are normally just
+	// pixelBuffer, but a presenter can point them somewhere else (such as locked texture memory).
+	uint32_t *pixels;
+	size_t pitch;
+
+public:
+	Framebuffer();
+	Framebuffer(int w, int h);
+	// Copies get their own pixelBuffer, holding whatever the original's pixels held
+	Framebuffer(const Framebuffer &other);
+	Framebuffer(Framebuffer &&other) = default;
+	Framebuffer &operator=(const Framebuffer &other);
+	Framebuffer &operator=(Framebuffer &&other) = default;
+	void savePPM(const std::string &filename) const;
+	void saveBMP(const std::string &filename) const;
+	void setPixelColour(size_t x, size_t y, uint32_t colour);
+	uint32_t getPixelColour(size_t x, size_t y);
+	// Unchecked access for renderers that clip up front (checked by asserts in debug builds only)
+	FramebufferView view();
+	uint32_t *rowPointer(size_t y);
+	size_t stride() const;
+	void fillSpan(size_t y, size_t x0, size_t x1, uint32_t colour);
+	void blit(size_t x, size_t y, const uint32_t *source, size_t sourceWidth, size_t sourceHeight, size_t sourceStride);
+	void clearPixels();
+};
@@ -0,0 +1,35 @@
+#include "FramebufferView.h"
+#include <algorithm>
+#include <cstring>
+
+FramebufferView::FramebufferView() : pixels(nullptr), width(0), height(0), stride(0) {}
+
+FramebufferView::FramebufferView(uint32_t *data, size_t w, size_t h, size_t rowStride) :
+		pixels(data), width(w), height(h), stride(rowStride) {}
+
+void FramebufferView::fillSpan(size_t y, size_t x0, size_t x1, uint32_t colour) const {
+	assert(x0 <= x1 && x1 < width);
+	uint32_t *start = row(y);
+	std::fill(start + x0, start + x1 + 1, colour);
+}
+
+void FramebufferView::fill(uint32_t colour) const {
+	if (stride == width) std::fill(pixels, pixels + width * height, colour);
+	else for (size_t y = 0; y < height; y++) std::fill(row(y), row(y) + width, colour);
+}
+
+void FramebufferView::blit(size_t x, size_t y, const uint32_t *source, size_t sourceWidth, size_t sourceHeight, size_t sourceStride) const {
+	assert(x + sourceWidth <= width && y + sourceHeight <= height);
+	for (size_t sourceY = 0; sourceY < sourceHeight; sourceY++) {
+		std::memcpy(row(y + sourceY) + x, source + sourceY * sourceStride, sourceWidth * sizeof(uint32_t));
+	}
+}
+
+void FramebufferView::blit(size_t x, size_t y, const FramebufferView &source) const {
+	blit(x, y, source.pixels, source.width, source.height, source.stride);
+}
+
+FramebufferView FramebufferView::region(size_t x, size_t y, size_t w, size_t h) const {
+	assert(x + w <= width && y + h <= height);
+	return FramebufferView(pixels + y * stride + x, w, h, stride);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+// Unowned, unchecked access to a block of ARGB8888 pixels. Callers clip once up front (e.g. to a triangle's
+// bounding box) and then write rows directly; the asserts only exist in debug builds, so release builds pay
+// nothing per pixel.
+struct FramebufferView {
+	uint32_t *pixels;
+	size_t width;
+	size_t height;
+	// distance between the starts of consecutive rows, in pixels
+	size_t stride;
+
+	FramebufferView();
+	FramebufferView(uint32_t *data, size_t w, size_t h, size_t rowStride);
+
+	uint32_t *row(size_t y) const {
+		assert(y < height);
+		return pixels + y * stride;
+	}
+	// Sets the pixels x0 to x1 inclusive of row y
+	void fillSpan(size_t y, size_t x0, size_t x1, uint32_t colour) const;
+	void fill(uint32_t colour) const;
+	// Copies a sourceWidth x sourceHeight block of pixels so that its top left lands on (x, y)
+	void blit(size_t x, size_t y, const uint32_t *source, size_t sourceWidth, size_t sourceHeight, size_t sourceStride) const;
+	void blit(size_t x, size_t y, const FramebufferView &source) const;
+	// The w x h rectangle whose top left is (x, y), sharing this view's pixels
+	FramebufferView region(size_t x, size_t y, size_t w, size_t h) const;
+};
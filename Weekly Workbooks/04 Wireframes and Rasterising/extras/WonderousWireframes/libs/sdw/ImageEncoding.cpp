@@ -0,0 +1,157 @@
+#include "ImageEncoding.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace {
+
+void appendLittleEndian(std::vector<uint8_t> &encoded, uint32_t value, int bytes) {
+	for (int i = 0; i < bytes; i++) encoded.push_back(uint8_t((value >> (8 * i)) & 0xFF));
+}
+
+bool endsWith(const std::string &text, const std::string &suffix) {
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+void packPixels(const uint32_t *argb, size_t count, uint8_t *packed, bool bgr) {
+	size_t i = 0;
+#if defined(__SSSE3__)
+	// Each shuffle turns 4 pixels into 12 bytes, stored as 16 (the last 4 are overwritten by the next block),
+	// so stop while there's still room for the spare 4 bytes
+	const __m128i order = bgr ? _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1)
+	                          : _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	for (; i + 6 <= count; i += 4) {
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(argb + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(packed + i * 3), _mm_shuffle_epi8(pixels, order));
+	}
+#endif
+	for (; i < count; i++) {
+		uint32_t pixel = argb[i];
+		uint8_t red = uint8_t(pixel >> 16);
+		uint8_t blue = uint8_t(pixel);
+		packed[i * 3 + 0] = bgr ? blue : red;
+		packed[i * 3 + 1] = uint8_t(pixel >> 8);
+		packed[i * 3 + 2] = bgr ? red : blue;
+	}
+}
+
+void unpackPixels(const uint8_t *rgb, size_t count, uint32_t *argb) {
+	size_t i = 0;
+#if defined(__SSSE3__)
+	// Each load takes 16 bytes but only uses the first 12 (4 pixels), so stop while the load stays in bounds
+	const __m128i order = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	const __m128i alpha = _mm_set1_epi32(int(0xFF000000));
+	for (; i + 6 <= count; i += 4) {
+		__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb + i * 3));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(argb + i), _mm_or_si128(_mm_shuffle_epi8(bytes, order), alpha));
+	}
+#endif
+	for (; i < count; i++) {
+		const uint8_t *pixel = rgb + i * 3;
+		argb[i] = (0xFFu << 24) | (uint32_t(pixel[0]) << 16) | (uint32_t(pixel[1]) << 8) | uint32_t(pixel[2]);
+	}
+}
+
+void encodePPM(const FramebufferView &image, std::vector<uint8_t> &encoded) {
+	std::string header = "P6\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+	size_t rowSize = image.width * 3;
+	encoded.resize(header.size() + rowSize * image.height);
+	std::memcpy(encoded.data(), header.data(), header.size());
+	uint8_t *out = encoded.data() + header.size();
+	if (image.stride == image.width) {
+		packPixels(image.pixels, image.width * image.height, out, false);
+	} else {
+		for (size_t y = 0; y < image.height; y++) packPixels(image.row(y), image.width, out + y * rowSize, false);
+	}
+}
+
+void encodeBMP(const FramebufferView &image, std::vector<uint8_t> &encoded) {
+	const uint32_t headerSize = 14 + 40;
+	uint32_t rowSize = (image.width * 3 + 3) & ~uint32_t(3);
+	uint32_t imageSize = rowSize * image.height;
+	encoded.clear();
+	encoded.reserve(headerSize + imageSize);
+	encoded.push_back('B');
+	encoded.push_back('M');
+	appendLittleEndian(encoded, headerSize + imageSize, 4);
+	appendLittleEndian(encoded, 0, 4);
+	appendLittleEndian(encoded, headerSize, 4);
+	appendLittleEndian(encoded, 40, 4);
+	appendLittleEndian(encoded, image.width, 4);
+	appendLittleEndian(encoded, image.height, 4);
+	appendLittleEndian(encoded, 1, 2);
+	appendLittleEndian(encoded, 24, 2);
+	appendLittleEndian(encoded, 0, 4);
+	appendLittleEndian(encoded, imageSize, 4);
+	// 2835 pixels per metre is 72 DPI
+	appendLittleEndian(encoded, 2835, 4);
+	appendLittleEndian(encoded, 2835, 4);
+	appendLittleEndian(encoded, 0, 4);
+	appendLittleEndian(encoded, 0, 4);
+
+	// zero filled, which takes care of the padding
+	encoded.resize(headerSize + imageSize, 0);
+	for (size_t y = 0; y < image.height; y++) {
+		packPixels(image.row(image.height - 1 - y), image.width, encoded.data() + headerSize + y * rowSize, true);
+	}
+}
+
+void encodeY4MFrame(const FramebufferView &image, std::vector<uint8_t> &encoded) {
+	const char marker[] = "FRAME\n";
+	const size_t markerSize = sizeof(marker) - 1;
+	size_t chromaWidth = (image.width + 1) / 2;
+	size_t chromaHeight = (image.height + 1) / 2;
+	size_t lumaSize = image.width * image.height;
+	size_t chromaSize = chromaWidth * chromaHeight;
+	encoded.resize(markerSize + lumaSize + 2 * chromaSize);
+	std::memcpy(encoded.data(), marker, markerSize);
+	uint8_t *lumaPlane = encoded.data() + markerSize;
+	uint8_t *uPlane = lumaPlane + lumaSize;
+	uint8_t *vPlane = uPlane + chromaSize;
+
+	for (size_t y = 0; y < image.height; y++) {
+		const uint32_t *row = image.row(y);
+		uint8_t *luma = lumaPlane + y * image.width;
+		for (size_t x = 0; x < image.width; x++) {
+			int red = (row[x] >> 16) & 0xFF;
+			int green = (row[x] >> 8) & 0xFF;
+			int blue = row[x] & 0xFF;
+			luma[x] = uint8_t(((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16);
+		}
+	}
+	for (size_t chromaY = 0; chromaY < chromaHeight; chromaY++) {
+		size_t top = chromaY * 2;
+		size_t bottom = std::min(top + 1, image.height - 1);
+		for (size_t chromaX = 0; chromaX < chromaWidth; chromaX++) {
+			size_t left = chromaX * 2;
+			size_t right = std::min(left + 1, image.width - 1);
+			uint32_t corners[4] = {image.row(top)[left], image.row(top)[right], image.row(bottom)[left], image.row(bottom)[right]};
+			int red = 0, green = 0, blue = 0;
+			for (uint32_t pixel : corners) {
+				red += (pixel >> 16) & 0xFF;
+				green += (pixel >> 8) & 0xFF;
+				blue += pixel & 0xFF;
+			}
+			// the sums are 4x the average, which the shift by 10 rather than 8 takes back out
+			uPlane[chromaY * chromaWidth + chromaX] = uint8_t(((-38 * red - 74 * green + 112 * blue + 512) >> 10) + 128);
+			vPlane[chromaY * chromaWidth + chromaX] = uint8_t(((112 * red - 94 * green - 18 * blue + 512) >> 10) + 128);
+		}
+	}
+}
+
+void encodeImage(const std::string &filename, const FramebufferView &image, std::vector<uint8_t> &encoded) {
+	if (endsWith(filename, ".bmp")) encodeBMP(image, encoded);
+	else encodePPM(image, encoded);
+}
+
+bool writeFile(const std::string &filename, const std::vector<uint8_t> &contents) {
+	FILE *file = std::fopen(filename.c_str(), "wb");
+	if (!file) return false;
+	bool written = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+	return std::fclose(file) == 0 && written;
+}
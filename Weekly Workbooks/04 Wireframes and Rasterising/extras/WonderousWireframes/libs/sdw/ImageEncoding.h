@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FramebufferView.h"
+
+// Converts count ARGB8888 pixels to packed 3 byte pixels (R, G, B, or B, G, R when bgr is set), a SIMD
+// block of pixels at a time where SSSE3 is available
+void packPixels(const uint32_t *argb, size_t count, uint8_t *packed, bool bgr);
+// The reverse for R, G, B bytes (as in a binary PPM), giving opaque ARGB8888
+void unpackPixels(const uint8_t *rgb, size_t count, uint32_t *argb);
+// Whole files in memory, so they can be written out in a single call
+void encodePPM(const FramebufferView &image, std::vector<uint8_t> &encoded);
+// Uncompressed 24 bit BMP: a 14 byte file header, a 40 byte BITMAPINFOHEADER, then rows of BGR from the
+// bottom of the image up, each padded to a multiple of 4 bytes
+void encodeBMP(const FramebufferView &image, std::vector<uint8_t> &encoded);
+// One frame of a YUV4MPEG2 stream ("FRAME\n" then the planes), as 4:2:0 with each chroma sample averaging a
+// 2x2 block of pixels (what the stream header's C420jpeg describes), using BT.601 studio range
+void encodeY4MFrame(const FramebufferView &image, std::vector<uint8_t> &encoded);
+// Picks BMP for names ending in .bmp, PPM otherwise
+void encodeImage(const std::string &filename, const FramebufferView &image, std::vector<uint8_t> &encoded);
+bool writeFile(const std::string &filename, const std::vector<uint8_t> &contents);
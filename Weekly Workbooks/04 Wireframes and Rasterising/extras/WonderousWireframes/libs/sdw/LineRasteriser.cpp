@@ -0,0 +1,100 @@
+#include "LineRasteriser.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+Line::Line() : x0(0.0f), y0(0.0f), x1(0.0f), y1(0.0f), colour(0) {}
+Line::Line(const CanvasPoint &from, const CanvasPoint &to, uint32_t lineColour) :
+		x0(from.x), y0(from.y), x1(to.x), y1(to.y), colour(lineColour) {}
+
+namespace {
+
+// Narrows [t0, t1] to the part of the line where p*t <= q holds
+bool clipAgainst(float p, float q, float &t0, float &t1) {
+	if (p == 0.0f) return q >= 0.0f;
+	float t = q / p;
+	if (p < 0.0f) {
+		if (t > t1) return false;
+		t0 = std::max(t0, t);
+	} else {
+		if (t < t0) return false;
+		t1 = std::min(t1, t);
+	}
+	return true;
+}
+
+// Liang-Barsky against the centres of the outermost pixels, so that rounding the result stays on screen
+bool clipLine(float &x0, float &y0, float &x1, float &y1, float maxX, float maxY) {
+	float dx = x1 - x0;
+	float dy = y1 - y0;
+	float t0 = 0.0f;
+	float t1 = 1.0f;
+	if (!(clipAgainst(-dx, x0, t0, t1) && clipAgainst(dx, maxX - x0, t0, t1) &&
+	      clipAgainst(-dy, y0, t0, t1) && clipAgainst(dy, maxY - y0, t0, t1))) return false;
+	float startX = x0 + t0 * dx;
+	float startY = y0 + t0 * dy;
+	x1 = x0 + t1 * dx;
+	y1 = y0 + t1 * dy;
+	x0 = startX;
+	y0 = startY;
+	return true;
+}
+
+int roundToPixel(float value, int maximum) {
+	return std::min(std::max(int(std::lround(value)), 0), maximum);
+}
+
+}
+
+void drawLine(const FramebufferView &target, const Line &line) {
+	float fx0 = line.x0, fy0 = line.y0, fx1 = line.x1, fy1 = line.y1;
+	if (!(std::isfinite(fx0) && std::isfinite(fy0) && std::isfinite(fx1) && std::isfinite(fy1))) return;
+	int maxX = int(target.width) - 1;
+	int maxY = int(target.height) - 1;
+	if (maxX < 0 || maxY < 0) return;
+	if (!clipLine(fx0, fy0, fx1, fy1, float(maxX), float(maxY))) return;
+	int x0 = roundToPixel(fx0, maxX), y0 = roundToPixel(fy0, maxY);
+	int x1 = roundToPixel(fx1, maxX), y1 = roundToPixel(fy1, maxY);
+
+	if (y0 == y1) {
+		uint32_t *row = target.row(y0);
+		std::fill(row + std::min(x0, x1), row + std::max(x0, x1) + 1, line.colour);
+		return;
+	}
+	ptrdiff_t stride = ptrdiff_t(target.stride);
+	if (x0 == x1) {
+		uint32_t *pixel = target.row(std::min(y0, y1)) + x0;
+		for (int y = std::min(y0, y1); y <= std::max(y0, y1); y++, pixel += stride) *pixel = line.colour;
+		return;
+	}
+
+	int dx = std::abs(x1 - x0);
+	int dy = -std::abs(y1 - y0);
+	int stepX = x0 < x1 ? 1 : -1;
+	int stepY = y0 < y1 ? 1 : -1;
+	uint32_t *pixel = target.row(y0) + x0;
+	int error = dx + dy;
+	while (true) {
+		*pixel = line.colour;
+		if (x0 == x1 && y0 == y1) break;
+		int doubled = 2 * error;
+		if (doubled >= dy) {
+			error += dy;
+			x0 += stepX;
+			pixel += stepX;
+		}
+		if (doubled <= dx) {
+			error += dx;
+			y0 += stepY;
+			pixel += stepY * stride;
+		}
+	}
+}
+
+void drawLines(const FramebufferView &target, const Line *lines, size_t count) {
+	for (size_t i = 0; i < count; i++) drawLine(target, lines[i]);
+}
+
+void drawLines(const FramebufferView &target, const std::vector<Line> &lines) {
+	drawLines(target, lines.data(), lines.size());
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CanvasPoint.h"
+#include "FramebufferView.h"
+
+struct Line {
+	float x0;
+	float y0;
+	float x1;
+	float y1;
+	uint32_t colour;
+
+	Line();
+	Line(const CanvasPoint &from, const CanvasPoint &to, uint32_t lineColour);
+};
+
+// Clips the line to the target (Liang-Barsky), then steps it with integer Bresenham. Only the pixels that
+// end up on screen cost anything, and horizontal and vertical lines are written as plain runs of memory.
+void drawLine(const FramebufferView &target, const Line &line);
+void drawLines(const FramebufferView &target, const Line *lines, size_t count);
+void drawLines(const FramebufferView &target, const std::vector<Line> &lines);
@@ -0,0 +1,72 @@
+#include "MappedFile.h"
+#include <cstdio>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &filename) : opened(false), contents(nullptr), length(0) {
+	FILE *file = std::fopen(filename.c_str(), "rb");
+	if (!file) return;
+	if (std::fseek(file, 0, SEEK_END) == 0) {
+		long end = std::ftell(file);
+		if (end >= 0) {
+			buffer.resize(size_t(end));
+			std::rewind(file);
+			opened = std::fread(buffer.data(), 1, buffer.size(), file) == buffer.size();
+		}
+	}
+	std::fclose(file);
+	contents = buffer.data();
+	length = opened ? buffer.size() : 0;
+}
+
+MappedFile::~MappedFile() = default;
+
+#else
+
+MappedFile::MappedFile(const std::string &filename) : opened(false), contents(nullptr), length(0) {
+	int descriptor = open(filename.c_str(), O_RDONLY);
+	if (descriptor < 0) return;
+	struct stat status;
+	if (fstat(descriptor, &status) == 0) {
+		length = size_t(status.st_size);
+		// mmap refuses to map nothing, but an empty file is still a file
+		if (length == 0) {
+			opened = true;
+		} else {
+			void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			if (mapping != MAP_FAILED) {
+				madvise(mapping, length, MADV_SEQUENTIAL);
+				contents = static_cast<const uint8_t *>(mapping);
+				opened = true;
+			} else {
+				length = 0;
+			}
+		}
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(descriptor);
+}
+
+MappedFile::~MappedFile() {
+	if (contents) munmap(const_cast<uint8_t *>(contents), length);
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+	return opened;
+}
+
+const uint8_t *MappedFile::data() const {
+	return contents;
+}
+
+size_t MappedFile::size() const {
+	return length;
+}
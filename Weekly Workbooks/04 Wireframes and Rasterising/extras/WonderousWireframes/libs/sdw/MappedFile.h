@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The whole of a file, read only, so it can be parsed in place rather than through a stream. It's memory
+// mapped on POSIX systems and read in a single call elsewhere.
+class MappedFile {
+public:
+	explicit MappedFile(const std::string &filename);
+	~MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool isOpen() const;
+	const uint8_t *data() const;
+	size_t size() const;
+
+private:
+	bool opened;
+	const uint8_t *contents;
+	size_t length;
+#ifdef _WIN32
+	std::vector<uint8_t> buffer;
+#endif
+};
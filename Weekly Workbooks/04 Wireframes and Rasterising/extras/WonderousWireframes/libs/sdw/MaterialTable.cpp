@@ -0,0 +1,68 @@
+#include "MaterialTable.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+float toLinear(int channel) {
+	float value = float(channel) / 255.0f;
+	return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+}
+
+const MaterialId MaterialTable::NONE;
+const size_t MaterialTable::MAX_MATERIALS;
+
+MaterialTable::MaterialTable() {
+	names.emplace_back();
+	packedColours.push_back(0xFF000000);
+	linearColours.emplace_back(0.0f);
+	texturePaths.emplace_back();
+	textures.emplace_back();
+}
+
+MaterialId MaterialTable::add(const std::string &name, int red, int green, int blue, const std::string &texturePath) {
+	auto found = ids.find(name);
+	if (found != ids.end()) return found->second;
+	if (names.size() >= MAX_MATERIALS) throw std::length_error("More than " + std::to_string(MAX_MATERIALS - 1) + " materials");
+	red = std::min(std::max(red, 0), 255);
+	green = std::min(std::max(green, 0), 255);
+	blue = std::min(std::max(blue, 0), 255);
+	MaterialId id = MaterialId(names.size());
+	names.push_back(name);
+	packedColours.push_back((0xFFu << 24) | (uint32_t(red) << 16) | (uint32_t(green) << 8) | uint32_t(blue));
+	linearColours.emplace_back(toLinear(red), toLinear(green), toLinear(blue));
+	texturePaths.push_back(texturePath);
+	textures.emplace_back();
+	ids.emplace(name, id);
+	return id;
+}
+
+MaterialId MaterialTable::find(const std::string &name) const {
+	auto found = ids.find(name);
+	return found != ids.end() ? found->second : NONE;
+}
+
+size_t MaterialTable::size() const {
+	return names.size();
+}
+
+const std::string &MaterialTable::name(MaterialId id) const {
+	return names[id];
+}
+
+Colour MaterialTable::colour(MaterialId id) const {
+	uint32_t colour = packedColours[id];
+	return Colour(names[id], int((colour >> 16) & 0xFF), int((colour >> 8) & 0xFF), int(colour & 0xFF));
+}
+
+const std::string &MaterialTable::texturePath(MaterialId id) const {
+	return texturePaths[id];
+}
+
+void MaterialTable::setTexture(MaterialId id, std::shared_ptr<const TextureMap> texture) {
+	textures[id] = std::move(texture);
+}
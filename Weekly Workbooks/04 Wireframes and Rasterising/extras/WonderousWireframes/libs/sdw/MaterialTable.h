@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Colour.h"
+
+class TextureMap;
+
+// Identifies a material in a MaterialTable, so triangles carry two bytes of material rather than a Colour
+typedef uint16_t MaterialId;
+
+// Materials interned by name, with everything drawing needs worked out once when they're added: the colour
+// packed as ARGB for the framebuffer, and as linear floats for lighting. Names are only looked up while
+// loading; after that everything goes by MaterialId. A material with a texture (its map_Kd) keeps the path,
+// and a handle to the texture once something loads it with setTexture.
+class MaterialTable {
+public:
+	// Always present: black, for triangles with no material (or one the MTL didn't define)
+	static const MaterialId NONE = 0;
+	static const size_t MAX_MATERIALS = 65536;
+
+	MaterialTable();
+
+	// red, green and blue are 0 to 255 (and clamped to that). Adding a name that's already there gives back the
+	// existing material unchanged. Throws std::length_error beyond MAX_MATERIALS.
+	MaterialId add(const std::string &name, int red, int green, int blue, const std::string &texturePath = "");
+	// NONE if there's no material by that name
+	MaterialId find(const std::string &name) const;
+	size_t size() const;
+
+	const std::string &name(MaterialId id) const;
+	uint32_t packed(MaterialId id) const {
+		return packedColours[id];
+	}
+	// Each channel decoded from sRGB to 0 to 1
+	glm::vec3 linear(MaterialId id) const {
+		return linearColours[id];
+	}
+	// The Colour older code expects, name and all
+	Colour colour(MaterialId id) const;
+	// Empty if the material has no texture
+	const std::string &texturePath(MaterialId id) const;
+	void setTexture(MaterialId id, std::shared_ptr<const TextureMap> texture);
+	// Null until setTexture
+	const TextureMap *texture(MaterialId id) const {
+		return textures[id].get();
+	}
+
+private:
+	std::vector<std::string> names;
+	std::vector<uint32_t> packedColours;
+	std::vector<glm::vec3> linearColours;
+	std::vector<std::string> texturePaths;
+	std::vector<std::shared_ptr<const TextureMap>> textures;
+	std::unordered_map<std::string, MaterialId> ids;
+};
@@ -0,0 +1,140 @@
+#include "Mesh.h"
+#include <limits>
+#include <unordered_map>
+#include "Culling.h"
+
+namespace {
+
+struct Corner {
+	uint32_t vertex;
+	uint32_t texturePoint;
+	uint32_t normal;
+
+	bool operator==(const Corner &other) const {
+		return vertex == other.vertex && texturePoint == other.texturePoint && normal == other.normal;
+	}
+};
+
+struct CornerHash {
+	size_t operator()(const Corner &corner) const {
+		uint64_t key = (uint64_t(corner.vertex) << 32) ^ (uint64_t(corner.texturePoint) << 16) ^ corner.normal;
+		return std::hash<uint64_t>()(key);
+	}
+};
+
+}
+
+size_t Mesh::triangleCount() const {
+	return materials.size();
+}
+
+ModelTriangle Mesh::triangle(size_t index) const {
+	ModelTriangle result;
+	for (int i = 0; i < 3; i++) {
+		uint32_t vertex = indices[index * 3 + i];
+		result.vertices[i] = positions[vertex];
+		if (!texturePoints.empty()) result.texturePoints[i] = TexturePoint(texturePoints[vertex].x, texturePoints[vertex].y);
+	}
+	result.colour = materialTable.colour(materials[index]);
+	result.normal = faceNormal(result);
+	return result;
+}
+
+size_t Mesh::sizeInBytes() const {
+	return positions.size() * sizeof(glm::vec3) + texturePoints.size() * sizeof(glm::vec2) + normals.size() * sizeof(glm::vec3) +
+	       indices.size() * sizeof(uint32_t) + materials.size() * sizeof(MaterialId);
+}
+
+Mesh buildMesh(const MeshView &mesh) {
+	Mesh result;
+	std::vector<MaterialId> materialIds(mesh.materialCount);
+	for (size_t m = 0; m < mesh.materialCount; m++) {
+		const MeshMaterial &material = mesh.materials[m];
+		materialIds[m] = result.materialTable.add(mesh.string(material.name), material.red, material.green, material.blue, mesh.string(material.texturePath));
+	}
+	bool anyTexturePoints = false;
+	bool anyNormals = false;
+	for (size_t t = 0; t < mesh.triangleCount; t++) {
+		for (int i = 0; i < 3; i++) {
+			anyTexturePoints |= mesh.triangles[t].texturePoints[i] != NO_INDEX;
+			anyNormals |= mesh.triangles[t].normals[i] != NO_INDEX;
+		}
+	}
+
+	// Objects are kept whole only if they run one after another from the first triangle to the last
+	std::vector<MeshPart> parts;
+	uint32_t covered = 0;
+	for (size_t o = 0; o < mesh.objectCount; o++) {
+		const MeshObject &object = mesh.objects[o];
+		if (object.firstTriangle != covered) break;
+		glm::vec3 low(object.boundsMin[0], object.boundsMin[1], object.boundsMin[2]);
+		glm::vec3 high(object.boundsMax[0], object.boundsMax[1], object.boundsMax[2]);
+		parts.push_back(MeshPart{mesh.string(object.name), object.firstTriangle, object.triangleCount, 0, 0, low, high});
+		covered += object.triangleCount;
+	}
+	if (covered != mesh.triangleCount) {
+		glm::vec3 low(std::numeric_limits<float>::max());
+		glm::vec3 high(std::numeric_limits<float>::lowest());
+		for (size_t t = 0; t < mesh.triangleCount; t++) {
+			for (uint32_t vertex : mesh.triangles[t].vertices) {
+				low = glm::min(low, mesh.vertices[vertex]);
+				high = glm::max(high, mesh.vertices[vertex]);
+			}
+		}
+		parts.assign(1, MeshPart{"", 0, uint32_t(mesh.triangleCount), 0, 0, low, high});
+	}
+
+	// Most positions only ever appear with one texture point and normal, so the first vertex made for each (in
+	// the current part) is checked directly, and only the other combinations need looking up
+	std::vector<Corner> sources;
+	std::vector<uint32_t> firstVertex(mesh.vertexCount, NO_INDEX);
+	std::unordered_map<Corner, uint32_t, CornerHash> otherVertices;
+	std::vector<uint32_t> indices;
+	std::vector<MaterialId> materials;
+	indices.reserve(mesh.triangleCount * 3);
+	materials.reserve(mesh.triangleCount);
+	for (MeshPart &part : parts) {
+		// anything made before this is another part's
+		part.firstVertex = uint32_t(sources.size());
+		for (size_t t = part.firstTriangle; t < part.firstTriangle + part.triangleCount; t++) {
+			const MeshTriangle &triangle = mesh.triangles[t];
+			for (int i = 0; i < 3; i++) {
+				Corner corner{triangle.vertices[i], anyTexturePoints ? triangle.texturePoints[i] : NO_INDEX, anyNormals ? triangle.normals[i] : NO_INDEX};
+				uint32_t &first = firstVertex[corner.vertex];
+				bool firstInPart = first != NO_INDEX && first >= part.firstVertex;
+				uint32_t vertex = first;
+				if (!firstInPart || !(sources[vertex] == corner)) {
+					auto found = firstInPart ? otherVertices.find(corner) : otherVertices.end();
+					if (found != otherVertices.end() && found->second >= part.firstVertex) {
+						vertex = found->second;
+					} else {
+						vertex = uint32_t(sources.size());
+						sources.push_back(corner);
+						if (!firstInPart) first = vertex;
+						else otherVertices[corner] = vertex;
+					}
+				}
+				indices.push_back(vertex);
+			}
+			materials.push_back(triangle.material != NO_INDEX ? materialIds[triangle.material] : MaterialTable::NONE);
+		}
+		part.vertexCount = uint32_t(sources.size()) - part.firstVertex;
+	}
+	result.parts = std::move(parts);
+	result.indices = MeshArray<uint32_t>(std::move(indices));
+	result.materials = MeshArray<MaterialId>(std::move(materials));
+
+	std::vector<glm::vec3> positions(sources.size());
+	std::vector<glm::vec2> texturePoints(anyTexturePoints ? sources.size() : 0);
+	std::vector<glm::vec3> normals(anyNormals ? sources.size() : 0);
+	for (size_t v = 0; v < sources.size(); v++) {
+		const Corner &source = sources[v];
+		positions[v] = mesh.vertices[source.vertex];
+		if (anyTexturePoints && source.texturePoint != NO_INDEX) texturePoints[v] = mesh.texturePoints[source.texturePoint];
+		if (anyNormals && source.normal != NO_INDEX) normals[v] = mesh.normals[source.normal];
+	}
+	result.positions = MeshArray<glm::vec3>(std::move(positions));
+	result.texturePoints = MeshArray<glm::vec2>(std::move(texturePoints));
+	result.normals = MeshArray<glm::vec3>(std::move(normals));
+	return result;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "MaterialTable.h"
+#include "MeshData.h"
+#include "ModelTriangle.h"
+
+class MeshFile;
+
+// An OBJ object's run of triangles, and the run of vertices they use (which no other part's triangles do)
+struct MeshPart {
+	std::string name;
+	uint32_t firstTriangle;
+	uint32_t triangleCount;
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+	// around its vertices, in the mesh's own space
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+
+// One of a Mesh's arrays, read only: either held in a vector of its own, or borrowed from memory something else
+// owns (a mapped MeshFile's). Copies of an owned array own a copy of it; copies of a borrowed one borrow the same.
+template <typename T>
+class MeshArray {
+public:
+	MeshArray() : values(nullptr), count(0) {}
+	explicit MeshArray(std::vector<T> owned) : ownedValues(std::move(owned)), values(ownedValues.data()), count(ownedValues.size()) {}
+	MeshArray(const T *borrowed, size_t borrowedCount) : values(borrowed), count(borrowedCount) {}
+	MeshArray(const MeshArray &other) : ownedValues(other.ownedValues), values(other.owns() ? ownedValues.data() : other.values), count(other.count) {}
+	// moving a vector keeps its elements where they are, so values stays good
+	MeshArray(MeshArray &&other) = default;
+	MeshArray &operator=(const MeshArray &other) {
+		ownedValues = other.ownedValues;
+		values = other.owns() ? ownedValues.data() : other.values;
+		count = other.count;
+		return *this;
+	}
+	MeshArray &operator=(MeshArray &&other) = default;
+
+	const T *data() const {
+		return values;
+	}
+	size_t size() const {
+		return count;
+	}
+	bool empty() const {
+		return count == 0;
+	}
+	const T &operator[](size_t index) const {
+		return values[index];
+	}
+	const T *begin() const {
+		return values;
+	}
+	const T *end() const {
+		return values + count;
+	}
+
+private:
+	std::vector<T> ownedValues;
+	const T *values;
+	size_t count;
+
+	bool owns() const {
+		return !ownedValues.empty();
+	}
+};
+
+// An indexed mesh, laid out for rendering: each vertex attribute in an array of its own, all indexed together
+// by three entries of indices per triangle. Corners of a part that share a position, texture point and normal
+// share a vertex, so it is stored (and transformed) once however many of the part's triangles use it.
+struct Mesh {
+	MeshArray<glm::vec3> positions;
+	// each is either empty (when no face gave one) or one per position, zero where a face left it out
+	MeshArray<glm::vec2> texturePoints;
+	MeshArray<glm::vec3> normals;
+	MeshArray<uint32_t> indices;
+	// per triangle
+	MeshArray<MaterialId> materials;
+	MaterialTable materialTable;
+	// in order, covering every triangle
+	std::vector<MeshPart> parts;
+	// Where the arrays are borrowed from, if they are, kept open for as long as this mesh (or a copy of it) is
+	std::shared_ptr<const MeshFile> file;
+
+	size_t triangleCount() const;
+	// The triangle as a ModelTriangle, for code that still works on those, with its face normal set
+	ModelTriangle triangle(size_t index) const;
+	// What the arrays hold, not counting the material table
+	size_t sizeInBytes() const;
+};
+
+// Merges the corners of the mesh's faces into shared vertices, with a part for each of its objects (or just the
+// one, if the objects don't cover its triangles in order)
+Mesh buildMesh(const MeshView &mesh);
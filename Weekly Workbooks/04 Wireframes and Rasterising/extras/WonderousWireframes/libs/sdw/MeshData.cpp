@@ -0,0 +1,63 @@
+#include "MeshData.h"
+#include <algorithm>
+#include <limits>
+#include "Culling.h"
+
+const char *MeshView::string(uint32_t offset) const {
+	return offset < stringsSize ? strings + offset : "";
+}
+
+uint32_t MeshData::addString(const std::string &text) {
+	if (text.empty()) return 0;
+	uint32_t offset = uint32_t(strings.size());
+	strings += text;
+	strings += '\0';
+	return offset;
+}
+
+MeshView MeshData::view() const {
+	return MeshView{vertices.data(), vertices.size(), texturePoints.data(), texturePoints.size(),
+	                normals.data(), normals.size(), triangles.data(), triangles.size(),
+	                materials.data(), materials.size(), objects.data(), objects.size(),
+	                strings.data(), strings.size()};
+}
+
+void computeObjectBounds(MeshData &mesh) {
+	for (MeshObject &object : mesh.objects) {
+		glm::vec3 low(std::numeric_limits<float>::max());
+		glm::vec3 high(std::numeric_limits<float>::lowest());
+		for (uint32_t t = object.firstTriangle; t < object.firstTriangle + object.triangleCount; t++) {
+			for (uint32_t vertex : mesh.triangles[t].vertices) {
+				low = glm::min(low, mesh.vertices[vertex]);
+				high = glm::max(high, mesh.vertices[vertex]);
+			}
+		}
+		for (int axis = 0; axis < 3; axis++) {
+			object.boundsMin[axis] = low[axis];
+			object.boundsMax[axis] = high[axis];
+		}
+	}
+}
+
+std::vector<ModelTriangle> modelTriangles(const MeshView &mesh) {
+	std::vector<Colour> colours(mesh.materialCount);
+	for (size_t m = 0; m < mesh.materialCount; m++) {
+		const MeshMaterial &material = mesh.materials[m];
+		colours[m] = Colour(mesh.string(material.name), material.red, material.green, material.blue);
+	}
+	std::vector<ModelTriangle> triangles(mesh.triangleCount);
+	for (size_t t = 0; t < mesh.triangleCount; t++) {
+		const MeshTriangle &source = mesh.triangles[t];
+		ModelTriangle &triangle = triangles[t];
+		for (int i = 0; i < 3; i++) {
+			triangle.vertices[i] = mesh.vertices[source.vertices[i]];
+			if (source.texturePoints[i] != NO_INDEX) {
+				glm::vec2 point = mesh.texturePoints[source.texturePoints[i]];
+				triangle.texturePoints[i] = TexturePoint(point.x, point.y);
+			}
+		}
+		if (source.material != NO_INDEX) triangle.colour = colours[source.material];
+		triangle.normal = faceNormal(triangle);
+	}
+	return triangles;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "ModelTriangle.h"
+
+// Fixed size records, with strings as offsets into a table of null terminated names. The binary mesh format (see
+// MeshFile.h) stores its materials as MeshMaterials too.
+const uint32_t NO_INDEX = 0xFFFFFFFF;
+
+struct MeshTriangle {
+	uint32_t vertices[3];
+	// NO_INDEX where the face didn't give one
+	uint32_t texturePoints[3];
+	uint32_t normals[3];
+	uint32_t material;
+};
+
+struct MeshMaterial {
+	uint32_t name;
+	// the Kd colour, 0 to 255 per channel
+	int32_t red;
+	int32_t green;
+	int32_t blue;
+	// map_Kd, relative to the working directory rather than the MTL file; offset 0 (the empty string) for none
+	uint32_t texturePath;
+};
+
+// An OBJ "o" (or "g"): a run of consecutive triangles
+struct MeshObject {
+	uint32_t name;
+	uint32_t firstTriangle;
+	uint32_t triangleCount;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+// A MeshData's contents, without owning them
+struct MeshView {
+	const glm::vec3 *vertices;
+	size_t vertexCount;
+	const glm::vec2 *texturePoints;
+	size_t texturePointCount;
+	const glm::vec3 *normals;
+	size_t normalCount;
+	const MeshTriangle *triangles;
+	size_t triangleCount;
+	const MeshMaterial *materials;
+	size_t materialCount;
+	const MeshObject *objects;
+	size_t objectCount;
+	const char *strings;
+	size_t stringsSize;
+
+	const char *string(uint32_t offset) const;
+};
+
+// A mesh built up in memory, from an OBJ
+struct MeshData {
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> texturePoints;
+	std::vector<glm::vec3> normals;
+	std::vector<MeshTriangle> triangles;
+	std::vector<MeshMaterial> materials;
+	std::vector<MeshObject> objects;
+	// starts with the empty string, at offset 0
+	std::string strings{std::string(1, '\0')};
+
+	uint32_t addString(const std::string &text);
+	MeshView view() const;
+};
+
+// Widens the bounds of every object to fit its triangles
+void computeObjectBounds(MeshData &mesh);
+// One ModelTriangle per triangle, coloured by its material, with its face normal set
+std::vector<ModelTriangle> modelTriangles(const MeshView &mesh);
@@ -0,0 +1,250 @@
+#include "MeshFile.h"
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <sys/stat.h>
+
+namespace {
+
+enum Section {
+	POSITIONS,
+	TEXTURE_POINTS,
+	NORMALS,
+	INDICES,
+	// per triangle
+	TRIANGLE_MATERIALS,
+	MATERIALS,
+	PARTS,
+	STRINGS,
+	SECTION_COUNT
+};
+
+const char MAGIC[8] = {'S', 'D', 'W', 'M', 'E', 'S', 'H', '\0'};
+const uint64_t ALIGNMENT = 16;
+
+struct SectionEntry {
+	uint64_t offset;
+	uint64_t count;
+};
+
+struct Header {
+	char magic[8];
+	uint32_t version;
+	uint32_t sectionCount;
+	// the OBJ's, then the MTL's
+	FileStamp sources[2];
+	SectionEntry sections[SECTION_COUNT];
+};
+
+// A MeshPart, with its name in the string table
+struct PartRecord {
+	uint32_t name;
+	uint32_t firstTriangle;
+	uint32_t triangleCount;
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+// the arrays are read straight out of the file as these types
+static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::vec2) == 8, "glm vectors must be tightly packed");
+static_assert(sizeof(MeshMaterial) == 20 && sizeof(PartRecord) == 44, "mesh records must not be padded");
+
+const size_t RECORD_SIZES[SECTION_COUNT] = {
+		sizeof(glm::vec3), sizeof(glm::vec2), sizeof(glm::vec3), sizeof(uint32_t), sizeof(MaterialId), sizeof(MeshMaterial), sizeof(PartRecord), 1};
+
+uint64_t aligned(uint64_t offset) {
+	return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+const char *stringAt(const char *strings, size_t size, uint32_t offset) {
+	return offset < size ? strings + offset : "";
+}
+
+// Every index in the mesh points inside it, and inside its own part's vertices, so nothing drawing it can stray
+// out of the file or out of a part's projected vertices
+bool indicesInRange(const Mesh &mesh) {
+	size_t vertexCount = mesh.positions.size();
+	if (!mesh.texturePoints.empty() && mesh.texturePoints.size() != vertexCount) return false;
+	if (!mesh.normals.empty() && mesh.normals.size() != vertexCount) return false;
+	if (mesh.indices.size() != mesh.materials.size() * 3) return false;
+	uint64_t covered = 0;
+	for (const MeshPart &part : mesh.parts) {
+		if (part.firstTriangle != covered || uint64_t(part.firstVertex) + part.vertexCount > vertexCount) return false;
+		covered += part.triangleCount;
+		if (covered > mesh.materials.size()) return false;
+		for (size_t i = size_t(part.firstTriangle) * 3; i < size_t(covered) * 3; i++) {
+			if (mesh.indices[i] - part.firstVertex >= part.vertexCount) return false;
+		}
+	}
+	if (covered != mesh.materials.size()) return false;
+	for (MaterialId material : mesh.materials) {
+		if (material >= mesh.materialTable.size()) return false;
+	}
+	return true;
+}
+
+template <typename T>
+MeshArray<T> borrowArray(const void *array, uint64_t count) {
+	return MeshArray<T>(static_cast<const T *>(array), size_t(count));
+}
+
+}
+
+bool FileStamp::operator==(const FileStamp &other) const {
+	return size == other.size && modified == other.modified;
+}
+
+bool stampFile(const std::string &filename, FileStamp &stamp) {
+#ifdef _WIN32
+	struct _stat64 status;
+	if (_stat64(filename.c_str(), &status) != 0) return false;
+#else
+	struct stat status;
+	if (stat(filename.c_str(), &status) != 0) return false;
+#endif
+	// in nanoseconds where the platform gives them, so an edit within a second of compiling still counts
+	int64_t modified = int64_t(status.st_mtime) * 1000000000;
+#if defined(__linux__)
+	modified += status.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+	modified += status.st_mtimespec.tv_nsec;
+#endif
+	stamp = FileStamp{uint64_t(status.st_size), modified};
+	return true;
+}
+
+MeshFile::MeshFile(const std::string &filename) : file(filename), valid(false), sources() {
+	if (!file.isOpen() || file.size() < sizeof(Header)) return;
+	Header header;
+	std::memcpy(&header, file.data(), sizeof(Header));
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.sectionCount != SECTION_COUNT) return;
+	const void *arrays[SECTION_COUNT];
+	uint64_t counts[SECTION_COUNT];
+	for (int s = 0; s < SECTION_COUNT; s++) {
+		const SectionEntry &section = header.sections[s];
+		if (section.offset % ALIGNMENT != 0 || section.offset > file.size()) return;
+		if (section.count > (file.size() - section.offset) / RECORD_SIZES[s]) return;
+		arrays[s] = file.data() + section.offset;
+		counts[s] = section.count;
+	}
+	const char *strings = static_cast<const char *>(arrays[STRINGS]);
+	size_t stringsSize = counts[STRINGS];
+	if (stringsSize == 0 || strings[stringsSize - 1] != '\0') return;
+
+	Mesh loaded;
+
+	loaded.positions = borrowArray<glm::vec3>(arrays[POSITIONS], counts[POSITIONS]);
+	loaded.texturePoints = borrowArray<glm::vec2>(arrays[TEXTURE_POINTS], counts[TEXTURE_POINTS]);
+	loaded.normals = borrowArray<glm::vec3>(arrays[NORMALS], counts[NORMALS]);
+	loaded.indices = borrowArray<uint32_t>(arrays[INDICES], counts[INDICES]);
+	loaded.materials = borrowArray<MaterialId>(arrays[TRIANGLE_MATERIALS], counts[TRIANGLE_MATERIALS]);
+	// the materials were written in MaterialId order, so adding them back gives each its old id (unless the
+	// file repeats a name, which no MaterialTable could have written)
+	if (counts[MATERIALS] >= MaterialTable::MAX_MATERIALS) return;
+	const MeshMaterial *materials = static_cast<const MeshMaterial *>(arrays[MATERIALS]);
+	for (size_t m = 0; m < counts[MATERIALS]; m++) {
+		const MeshMaterial &material = materials[m];
+		MaterialId id = loaded.materialTable.add(stringAt(strings, stringsSize, material.name), material.red, material.green, material.blue,
+		                                           stringAt(strings, stringsSize, material.texturePath));
+		if (id != m + 1) return;
+	}
+	const PartRecord *parts = static_cast<const PartRecord *>(arrays[PARTS]);
+	for (size_t p = 0; p < counts[PARTS]; p++) {
+		const PartRecord &part = parts[p];
+		glm::vec3 low(part.boundsMin[0], part.boundsMin[1], part.boundsMin[2]);
+		glm::vec3 high(part.boundsMax[0], part.boundsMax[1], part.boundsMax[2]);
+		loaded.parts.push_back(MeshPart{stringAt(strings, stringsSize, part.name), part.firstTriangle, part.triangleCount, part.firstVertex, part.vertexCount, low, high});
+	}
+	if (!indicesInRange(loaded)) return;
+	contents = std::move(loaded);
+	sources[0] = header.sources[0];
+	sources[1] = header.sources[1];
+	valid = true;
+}
+
+bool MeshFile::isValid() const {
+	return valid;
+}
+
+bool MeshFile::isCompiledFrom(const std::string &objFilename, const std::string &mtlFilename) const {
+	FileStamp obj, mtl;
+	return valid && stampFile(objFilename, obj) && stampFile(mtlFilename, mtl) && obj == sources[0] && mtl == sources[1];
+}
+
+const Mesh &MeshFile::mesh() const {
+	return contents;
+}
+
+Mesh borrowMesh(const std::shared_ptr<const MeshFile> &file) {
+	Mesh mesh = file->mesh();
+	mesh.file = file;
+	return mesh;
+}
+
+bool writeMeshFile(const std::string &filename, const Mesh &mesh, const std::string &objFilename, const std::string &mtlFilename) {
+	Header header{};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = MeshFile::VERSION;
+	header.sectionCount = SECTION_COUNT;
+	if (!stampFile(objFilename, header.sources[0]) || !stampFile(mtlFilename, header.sources[1])) return false;
+
+	// offset 0 is the empty string
+	std::string strings(1, '\0');
+	auto addString = [&](const std::string &text) {
+		if (text.empty()) return uint32_t(0);
+		uint32_t offset = uint32_t(strings.size());
+		strings.append(text).push_back('\0');
+		return offset;
+	};
+	// NONE is always there, so only the materials after it are written
+	std::vector<MeshMaterial> materials;
+	for (size_t id = 1; id < mesh.materialTable.size(); id++) {
+		uint32_t colour = mesh.materialTable.packed(MaterialId(id));
+		materials.push_back(MeshMaterial{addString(mesh.materialTable.name(MaterialId(id))), int32_t((colour >> 16) & 0xFF), int32_t((colour >> 8) & 0xFF),
+		                                 int32_t(colour & 0xFF), addString(mesh.materialTable.texturePath(MaterialId(id)))});
+	}
+	std::vector<PartRecord> parts;
+	for (const MeshPart &part : mesh.parts) {
+		parts.push_back(PartRecord{addString(part.name), part.firstTriangle, part.triangleCount, part.firstVertex, part.vertexCount,
+		                           {part.boundsMin.x, part.boundsMin.y, part.boundsMin.z}, {part.boundsMax.x, part.boundsMax.y, part.boundsMax.z}});
+	}
+
+	const void *arrays[SECTION_COUNT] = {mesh.positions.data(), mesh.texturePoints.data(), mesh.normals.data(), mesh.indices.data(),
+	                                     mesh.materials.data(), materials.data(), parts.data(), strings.data()};
+	size_t counts[SECTION_COUNT] = {mesh.positions.size(), mesh.texturePoints.size(), mesh.normals.size(), mesh.indices.size(),
+	                                mesh.materials.size(), materials.size(), parts.size(), strings.size()};
+	uint64_t offset = aligned(sizeof(Header));
+	for (int s = 0; s < SECTION_COUNT; s++) {
+		header.sections[s] = SectionEntry{offset, counts[s]};
+		offset = aligned(offset + counts[s] * RECORD_SIZES[s]);
+	}
+
+	std::string temporary = filename + ".tmp";
+	FILE *out = std::fopen(temporary.c_str(), "wb");
+	if (!out) return false;
+	const char padding[ALIGNMENT] = {};
+	bool ok = std::fwrite(&header, sizeof(Header), 1, out) == 1;
+	uint64_t written = sizeof(Header);
+	for (int s = 0; s < SECTION_COUNT && ok; s++) {
+		ok = std::fwrite(padding, 1, header.sections[s].offset - written, out) == header.sections[s].offset - written;
+		size_t bytes = counts[s] * RECORD_SIZES[s];
+		if (ok && bytes > 0) ok = std::fwrite(arrays[s], 1, bytes, out) == bytes;
+		written = header.sections[s].offset + bytes;
+	}
+	ok = std::fclose(out) == 0 && ok;
+	// rename won't replace an existing file everywhere
+	std::remove(filename.c_str());
+	if (!ok || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+		std::remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+std::string meshFilenameFor(const std::string &objFilename) {
+	size_t length = objFilename.size();
+	if (length >= 4 && objFilename.compare(length - 4, 4, ".obj") == 0) return objFilename.substr(0, length - 4) + ".mesh";
+	return objFilename + ".mesh";
+}
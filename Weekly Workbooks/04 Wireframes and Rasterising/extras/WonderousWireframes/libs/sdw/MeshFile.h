@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "MappedFile.h"
+#include "Mesh.h"
+
+// When a source file was last changed, as far as deciding whether a compiled mesh is stale goes
+struct FileStamp {
+	uint64_t size;
+	int64_t modified;
+
+	bool operator==(const FileStamp &other) const;
+};
+
+// False if the file doesn't exist
+bool stampFile(const std::string &filename, FileStamp &stamp);
+
+// A compiled mesh, as written by writeMeshFile: a header, then each of Mesh's arrays as they sit in memory
+// (native byte order), each starting on a 16 byte boundary, followed by its materials and parts as fixed size
+// records. The file is mapped and its arrays used in place, already merged into vertices: opening it only adds
+// back the materials and parts and checks that the header and every index are in range.
+class MeshFile {
+public:
+	static const uint32_t VERSION = 2;
+
+	explicit MeshFile(const std::string &filename);
+
+	bool isValid() const;
+	// Whether it was compiled from these files as they are now
+	bool isCompiledFrom(const std::string &objFilename, const std::string &mtlFilename) const;
+	// Empty unless the file is valid. Its arrays point into the file, so only while this MeshFile is open.
+	const Mesh &mesh() const;
+
+private:
+	MappedFile file;
+	bool valid;
+	FileStamp sources[2];
+	Mesh contents;
+};
+
+// The file's mesh, holding on to the file so that it stays mapped for as long as the mesh (or any copy of it) lives
+Mesh borrowMesh(const std::shared_ptr<const MeshFile> &file);
+// Writes to a temporary file first and renames it into place, so a reader never sees half a mesh
+bool writeMeshFile(const std::string &filename, const Mesh &mesh, const std::string &objFilename, const std::string &mtlFilename);
+// The OBJ's name with .mesh in place of .obj
+std::string meshFilenameFor(const std::string &objFilename);
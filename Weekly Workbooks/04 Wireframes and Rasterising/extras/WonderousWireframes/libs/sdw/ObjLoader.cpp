@@ -0,0 +1,396 @@
+#include "ObjLoader.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include "MappedFile.h"
+
+namespace {
+
+// Below this, splitting the file costs more than it saves
+const size_t MINIMUM_CHUNK_SIZE = size_t(1) << 20;
+// A chunk's triangles before its first usemtl carry on with whatever material the chunk before ended with
+const uint32_t CONTINUED_MATERIAL = 0xFFFFFFFE;
+const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+const char *skipSpaces(const char *p, const char *end) {
+	while (p != end && isSpace(*p)) p++;
+	return p;
+}
+
+const char *tokenEnd(const char *p, const char *end) {
+	while (p != end && !isSpace(*p)) p++;
+	return p;
+}
+
+// The rest of the line, without the whitespace around it
+std::string restOfLine(const char *p, const char *end) {
+	p = skipSpaces(p, end);
+	while (end != p && isSpace(end[-1])) end--;
+	return std::string(p, end);
+}
+
+// Decimals as OBJ files write them (up to 19 significant digits, with an optional exponent) are converted
+// with a single rounding to double, so they come out as strtof would give them barring a rare last-bit
+// difference. Anything else (inf, hex, very long or very large numbers) goes to strtof itself.
+const char *parseFloat(const char *p, const char *end, float &value) {
+	const char *start = p;
+	bool negative = p != end && *p == '-';
+	if (p != end && (*p == '-' || *p == '+')) p++;
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool anyDigits = false;
+	bool exact = true;
+	for (; p != end && isDigit(*p); p++, anyDigits = true) {
+		if (significantDigits < 19) {
+			mantissa = mantissa * 10 + uint64_t(*p - '0');
+			if (mantissa != 0) significantDigits++;
+		} else {
+			exponent++;
+			exact = false;
+		}
+	}
+	if (p != end && *p == '.') {
+		for (p++; p != end && isDigit(*p); p++, anyDigits = true) {
+			if (significantDigits < 19) {
+				mantissa = mantissa * 10 + uint64_t(*p - '0');
+				if (mantissa != 0) significantDigits++;
+				exponent--;
+			} else {
+				exact = false;
+			}
+		}
+	}
+	if (anyDigits && p != end && (*p == 'e' || *p == 'E')) {
+		const char *exponentStart = p++;
+		bool negativeExponent = p != end && *p == '-';
+		if (p != end && (*p == '-' || *p == '+')) p++;
+		if (p == end || !isDigit(*p)) {
+			p = exponentStart;
+		} else {
+			int written = 0;
+			for (; p != end && isDigit(*p); p++) written = std::min(written * 10 + (*p - '0'), 100000);
+			exponent += negativeExponent ? -written : written;
+		}
+	}
+	bool fits = mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22;
+	if (anyDigits && exact && fits && (p == end || isSpace(*p))) {
+		double magnitude = exponent < 0 ? double(mantissa) / POWERS_OF_TEN[-exponent] : double(mantissa) * POWERS_OF_TEN[exponent];
+		value = float(negative ? -magnitude : magnitude);
+		return p;
+	}
+	std::string token(start, tokenEnd(start, end));
+	value = std::strtof(token.c_str(), nullptr);
+	return start + token.size();
+}
+
+// Indices as written: from 1, or counting back from -1. Returns false for a malformed one or a 0.
+bool parseInteger(const char *&p, const char *end, int64_t &value) {
+	bool negative = p != end && *p == '-';
+	if (p != end && (*p == '-' || *p == '+')) p++;
+	if (p == end || !isDigit(*p)) return false;
+	int64_t magnitude = 0;
+	for (; p != end && isDigit(*p); p++) magnitude = std::min<int64_t>(magnitude * 10 + (*p - '0'), int64_t(1) << 40);
+	value = negative ? -magnitude : magnitude;
+	return magnitude != 0;
+}
+
+// What one thread makes of its share of the file. Indices that count back from the end are resolved against
+// the chunk's own counts and flagged, to be moved along once the chunks before it are known. Until then they
+// are signed (an int32_t stored in the uint32_t), as they may reach back into the chunks before.
+struct Chunk {
+	std::vector<glm::vec3> vertices;
+	std::vector<glm::vec2> texturePoints;
+	std::vector<glm::vec3> normals;
+	std::vector<MeshTriangle> triangles;
+	// per triangle, bit attribute * 3 + corner is set for a relative index (attributes in the order vertex,
+	// texture point, normal)
+	std::vector<uint16_t> relative;
+	// the names used by usemtl, which each triangle's material indexes (or is CONTINUED_MATERIAL)
+	std::vector<std::string> materialNames;
+	uint32_t lastMaterial = CONTINUED_MATERIAL;
+	// with firstTriangle counted from the chunk's first
+	std::vector<MeshObject> objects;
+	std::vector<std::string> objectNames;
+	std::string materialLibrary;
+	std::string error;
+};
+
+void parseFace(const char *p, const char *end, Chunk &chunk, std::vector<uint32_t> &corners, std::vector<uint16_t> &cornerRelative) {
+	corners.clear();
+	cornerRelative.clear();
+	size_t counts[3] = {chunk.vertices.size(), chunk.texturePoints.size(), chunk.normals.size()};
+	// each corner is v, v/vt, v//vn or v/vt/vn (with empty fields allowed, as in "2/")
+	for (p = skipSpaces(p, end); p != end; p = skipSpaces(p, end)) {
+		uint16_t relative = 0;
+		for (int attribute = 0; attribute < 3; attribute++) {
+			uint32_t index = NO_INDEX;
+			if (p != end && !isSpace(*p) && *p != '/') {
+				int64_t value;
+				if (!parseInteger(p, end, value)) {
+					chunk.error = "Malformed face index";
+					return;
+				}
+				if (value < 0) {
+					relative |= uint16_t(1 << attribute);
+					value += int64_t(counts[attribute]);
+				} else {
+					value -= 1;
+				}
+				// none may pass for NO_INDEX, or reach beyond what a relative one can hold
+				bool inRange = relative & (1 << attribute) ? value >= INT32_MIN : value >= 0 && value < int64_t(NO_INDEX);
+				if (!inRange) {
+					chunk.error = "A face index is out of range";
+					return;
+				}
+				index = uint32_t(value);
+			}
+			corners.push_back(index);
+			if (attribute < 2 && p != end && *p == '/') p++;
+			else for (attribute++; attribute < 3; attribute++) corners.push_back(NO_INDEX);
+		}
+		if (corners[corners.size() - 3] == NO_INDEX && !(relative & 1)) {
+			chunk.error = "A face has a corner with no vertex";
+			return;
+		}
+		cornerRelative.push_back(relative);
+		p = tokenEnd(p, end);
+	}
+	size_t cornerCount = cornerRelative.size();
+	if (cornerCount < 3) return;
+	uint32_t material = chunk.materialNames.empty() ? CONTINUED_MATERIAL : chunk.lastMaterial;
+	// polygons become fans around their first corner
+	for (size_t corner = 1; corner + 1 < cornerCount; corner++) {
+		size_t fan[3] = {0, corner, corner + 1};
+		MeshTriangle triangle;
+		uint16_t relative = 0;
+		for (int i = 0; i < 3; i++) {
+			triangle.vertices[i] = corners[fan[i] * 3];
+			triangle.texturePoints[i] = corners[fan[i] * 3 + 1];
+			triangle.normals[i] = corners[fan[i] * 3 + 2];
+			for (int attribute = 0; attribute < 3; attribute++) {
+				if (cornerRelative[fan[i]] & (1 << attribute)) relative |= uint16_t(1 << (attribute * 3 + i));
+			}
+		}
+		triangle.material = material;
+		chunk.triangles.push_back(triangle);
+		chunk.relative.push_back(relative);
+	}
+}
+
+void parseChunk(const char *begin, const char *end, Chunk &chunk) {
+	std::vector<uint32_t> corners;
+	std::vector<uint16_t> cornerRelative;
+	for (const char *line = begin; line < end && chunk.error.empty();) {
+		const char *lineEnd = static_cast<const char *>(std::memchr(line, '\n', size_t(end - line)));
+		if (!lineEnd) lineEnd = end;
+		const char *p = skipSpaces(line, lineEnd);
+		const char *keywordEnd = tokenEnd(p, lineEnd);
+		size_t length = size_t(keywordEnd - p);
+		p = skipSpaces(keywordEnd, lineEnd);
+		const char *keyword = keywordEnd - length;
+		if (length == 1 && keyword[0] == 'v') {
+			glm::vec3 vertex;
+			for (int axis = 0; axis < 3; axis++) p = skipSpaces(parseFloat(p, lineEnd, vertex[axis]), lineEnd);
+			chunk.vertices.push_back(vertex);
+		} else if (length == 2 && keyword[0] == 'v' && keyword[1] == 't') {
+			glm::vec2 point;
+			for (int axis = 0; axis < 2; axis++) p = skipSpaces(parseFloat(p, lineEnd, point[axis]), lineEnd);
+			chunk.texturePoints.push_back(point);
+		} else if (length == 2 && keyword[0] == 'v' && keyword[1] == 'n') {
+			glm::vec3 normal;
+			for (int axis = 0; axis < 3; axis++) p = skipSpaces(parseFloat(p, lineEnd, normal[axis]), lineEnd);
+			chunk.normals.push_back(normal);
+		} else if (length == 1 && keyword[0] == 'f') {
+			parseFace(p, lineEnd, chunk, corners, cornerRelative);
+		} else if (length == 1 && (keyword[0] == 'o' || keyword[0] == 'g')) {
+			chunk.objects.push_back(MeshObject{0, uint32_t(chunk.triangles.size()), 0, {}, {}});
+			chunk.objectNames.push_back(restOfLine(p, lineEnd));
+		} else if (length == 6 && std::memcmp(keyword, "usemtl", 6) == 0) {
+			chunk.lastMaterial = uint32_t(chunk.materialNames.size());
+			chunk.materialNames.push_back(restOfLine(p, lineEnd));
+		} else if (length == 6 && std::memcmp(keyword, "mtllib", 6) == 0 && chunk.materialLibrary.empty()) {
+			chunk.materialLibrary = restOfLine(p, lineEnd);
+		}
+		line = lineEnd + 1;
+	}
+}
+
+std::unordered_map<std::string, uint32_t> loadMaterials(const std::string &mtlFilename, MeshData &mesh) {
+	std::ifstream file(mtlFilename);
+	if (!file) throw std::invalid_argument("Could not open " + mtlFilename);
+	// texture paths are relative to the material file
+	std::string directory = mtlFilename.substr(0, mtlFilename.find_last_of("/\\") + 1);
+	std::unordered_map<std::string, uint32_t> indices;
+	MeshMaterial *current = nullptr;
+	std::string line;
+	while (std::getline(file, line)) {
+		const char *end = line.data() + line.size();
+		const char *keyword = skipSpaces(line.data(), end);
+		const char *p = tokenEnd(keyword, end);
+		std::string name(keyword, p);
+		if (name == "newmtl") {
+			std::string materialName = restOfLine(p, end);
+			indices[materialName] = uint32_t(mesh.materials.size());
+			mesh.materials.push_back(MeshMaterial{mesh.addString(materialName), 0, 0, 0, 0});
+			current = &mesh.materials.back();
+		} else if (current && name == "Kd") {
+			float channels[3] = {};
+			for (float &channel : channels) p = parseFloat(skipSpaces(p, end), end, channel);
+			current->red = int32_t(channels[0] * 255);
+			current->green = int32_t(channels[1] * 255);
+			current->blue = int32_t(channels[2] * 255);
+		} else if (current && name == "map_Kd") {
+			// any options come before the file name
+			const char *trimmed = end;
+			while (trimmed != p && isSpace(trimmed[-1])) trimmed--;
+			const char *fileName = trimmed;
+			while (fileName != p && !isSpace(fileName[-1])) fileName--;
+			current->texturePath = mesh.addString(directory + std::string(fileName, trimmed));
+		}
+	}
+	return indices;
+}
+
+// Appends the chunk to the mesh, moving its relative indices and its triangles' objects and materials along
+// to where it sits in the whole file. Returns false if a relative index reaches back before the first.
+bool mergeChunk(const Chunk &chunk, const std::unordered_map<std::string, uint32_t> &materials, uint32_t &material, MeshData &mesh) {
+	uint32_t bases[3] = {uint32_t(mesh.vertices.size()), uint32_t(mesh.texturePoints.size()), uint32_t(mesh.normals.size())};
+	uint32_t firstTriangle = uint32_t(mesh.triangles.size());
+	mesh.vertices.insert(mesh.vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+	mesh.texturePoints.insert(mesh.texturePoints.end(), chunk.texturePoints.begin(), chunk.texturePoints.end());
+	mesh.normals.insert(mesh.normals.end(), chunk.normals.begin(), chunk.normals.end());
+
+	std::vector<uint32_t> materialIndices;
+	for (const std::string &name : chunk.materialNames) {
+		auto found = materials.find(name);
+		materialIndices.push_back(found != materials.end() ? found->second : NO_INDEX);
+	}
+	for (size_t t = 0; t < chunk.triangles.size(); t++) {
+		MeshTriangle triangle = chunk.triangles[t];
+		uint32_t *indices[3] = {triangle.vertices, triangle.texturePoints, triangle.normals};
+		for (int attribute = 0; attribute < 3; attribute++) {
+			for (int i = 0; i < 3; i++) {
+				if (!(chunk.relative[t] & (1 << (attribute * 3 + i)))) continue;
+				int64_t index = int64_t(int32_t(indices[attribute][i])) + int64_t(bases[attribute]);
+				if (index < 0) return false;
+				indices[attribute][i] = uint32_t(index);
+			}
+		}
+		if (triangle.material != CONTINUED_MATERIAL) material = materialIndices[triangle.material];
+		triangle.material = material;
+		mesh.triangles.push_back(triangle);
+	}
+	if (chunk.lastMaterial != CONTINUED_MATERIAL) material = materialIndices[chunk.lastMaterial];
+
+	// the triangles before the chunk's first object belong to the last one of the chunk before
+	uint32_t leading = chunk.objects.empty() ? uint32_t(chunk.triangles.size()) : chunk.objects[0].firstTriangle;
+	if (leading > 0) {
+		if (mesh.objects.empty()) mesh.objects.push_back(MeshObject{0, firstTriangle, 0, {}, {}});
+		mesh.objects.back().triangleCount += leading;
+	}
+	for (size_t o = 0; o < chunk.objects.size(); o++) {
+		uint32_t next = o + 1 < chunk.objects.size() ? chunk.objects[o + 1].firstTriangle : uint32_t(chunk.triangles.size());
+		uint32_t first = chunk.objects[o].firstTriangle;
+		mesh.objects.push_back(MeshObject{mesh.addString(chunk.objectNames[o]), firstTriangle + first, next - first, {}, {}});
+	}
+	return true;
+}
+
+bool indicesInRange(const MeshData &mesh) {
+	size_t counts[3] = {mesh.vertices.size(), mesh.texturePoints.size(), mesh.normals.size()};
+	for (const MeshTriangle &triangle : mesh.triangles) {
+		const uint32_t *indices[3] = {triangle.vertices, triangle.texturePoints, triangle.normals};
+		for (int attribute = 0; attribute < 3; attribute++) {
+			for (int i = 0; i < 3; i++) {
+				uint32_t index = indices[attribute][i];
+				if ((attribute == 0 || index != NO_INDEX) && index >= counts[attribute]) return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+MeshData loadObj(const std::string &objFilename, const std::string &mtlFilename) {
+	MappedFile file(objFilename);
+	if (!file.isOpen()) throw std::invalid_argument("Could not open " + objFilename);
+	const char *text = reinterpret_cast<const char *>(file.data());
+	size_t size = file.size();
+
+	// one chunk per hardware thread, each starting at the beginning of a line
+	size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+	size_t chunkCount = std::max<size_t>(1, std::min(threadCount, size / MINIMUM_CHUNK_SIZE));
+	std::vector<size_t> boundaries(1, 0);
+	for (size_t c = 1; c < chunkCount; c++) {
+		size_t boundary = std::max(boundaries.back(), size * c / chunkCount);
+		const void *newline = std::memchr(text + boundary, '\n', size - boundary);
+		boundaries.push_back(newline ? size_t(static_cast<const char *>(newline) - text) + 1 : size);
+	}
+	boundaries.push_back(size);
+
+	std::vector<Chunk> chunks(chunkCount);
+	std::vector<std::thread> workers;
+	for (size_t c = 1; c < chunkCount; c++) {
+		workers.emplace_back(parseChunk, text + boundaries[c], text + boundaries[c + 1], std::ref(chunks[c]));
+	}
+	parseChunk(text + boundaries[0], text + boundaries[1], chunks[0]);
+	for (std::thread &worker : workers) worker.join();
+	for (const Chunk &chunk : chunks) {
+		if (!chunk.error.empty()) throw std::invalid_argument(chunk.error + " in " + objFilename);
+	}
+
+	MeshData mesh;
+	std::string materialLibrary = mtlFilename;
+	if (materialLibrary.empty()) {
+		for (const Chunk &chunk : chunks) {
+			if (chunk.materialLibrary.empty()) continue;
+			// relative to the OBJ
+			materialLibrary = objFilename.substr(0, objFilename.find_last_of("/\\") + 1) + chunk.materialLibrary;
+			break;
+		}
+	}
+	std::unordered_map<std::string, uint32_t> materials;
+	if (!materialLibrary.empty()) materials = loadMaterials(materialLibrary, mesh);
+
+	size_t totals[4] = {};
+	for (const Chunk &chunk : chunks) {
+		totals[0] += chunk.vertices.size();
+		totals[1] += chunk.texturePoints.size();
+		totals[2] += chunk.normals.size();
+		totals[3] += chunk.triangles.size();
+	}
+	mesh.vertices.reserve(totals[0]);
+	mesh.texturePoints.reserve(totals[1]);
+	mesh.normals.reserve(totals[2]);
+	mesh.triangles.reserve(totals[3]);
+	uint32_t material = NO_INDEX;
+	for (Chunk &chunk : chunks) {
+		if (!mergeChunk(chunk, materials, material, mesh)) throw std::invalid_argument("A face in " + objFilename + " refers to a missing index");
+		// free each chunk as soon as it's copied, so the peak is closer to one copy of the mesh than two
+		chunk = Chunk();
+	}
+	if (!indicesInRange(mesh)) throw std::invalid_argument("A face in " + objFilename + " refers to a missing index");
+
+	// objects that never got any faces have nothing to bound
+	mesh.objects.erase(std::remove_if(mesh.objects.begin(), mesh.objects.end(),
+	                                  [](const MeshObject &object) { return object.triangleCount == 0; }),
+	                   mesh.objects.end());
+	computeObjectBounds(mesh);
+	return mesh;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+#include "MeshData.h"
+
+// Reads an OBJ's vertices (v), texture points (vt), normals (vn), faces (f, with polygons split into fans)
+// and objects (o or g), coloured by the materials (newmtl, Kd and map_Kd) in the MTL file. Indices may be
+// negative, counting back from the latest. Without an mtlFilename, the OBJ's first mtllib is used. Large files
+// are mapped and parsed in parallel chunks. Throws std::invalid_argument if either file can't be read, or a
+// face refers to something that doesn't exist.
+MeshData loadObj(const std::string &objFilename, const std::string &mtlFilename = "");
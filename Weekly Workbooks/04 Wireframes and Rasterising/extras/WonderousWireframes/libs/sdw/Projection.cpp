@@ -0,0 +1,65 @@
+#include "Projection.h"
+#include <algorithm>
+#include "SimdLanes.h"
+
+namespace {
+
+// the vertices are read straight out of a vec3 array as consecutive floats
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must not be padded");
+
+// Projects LANE_COUNT vertices, from consecutive x, y, z triples
+void projectBlock(const Projection &projection, const float *positions, float *x, float *y, float *depth) {
+	using namespace lanes;
+	Floats worldX, worldY, worldZ;
+	loadTriples(positions, worldX, worldY, worldZ);
+	Floats relativeX = sub(worldX, broadcast(projection.cameraPosition.x));
+	Floats relativeY = sub(worldY, broadcast(projection.cameraPosition.y));
+	Floats relativeZ = sub(worldZ, broadcast(projection.cameraPosition.z));
+	// into camera space, along each of the camera's axes in turn
+	Floats view[3];
+	for (int axis = 0; axis < 3; axis++) {
+		const glm::vec3 &direction = projection.orientation[axis];
+		view[axis] = add(add(mul(relativeX, broadcast(direction.x)), mul(relativeY, broadcast(direction.y))),
+		                 mul(relativeZ, broadcast(direction.z)));
+	}
+	// the same operations, in the same order, as projectVertex
+	Floats u = mul(mul(broadcast(-projection.focalLength), div(view[0], view[2])), broadcast(projection.imagePlaneScale));
+	Floats v = mul(mul(broadcast(projection.focalLength), div(view[1], view[2])), broadcast(projection.imagePlaneScale));
+	store(x, add(u, broadcast(projection.canvasWidth / 2.0f)));
+	store(y, add(v, broadcast(projection.canvasHeight / 2.0f)));
+	store(depth, div(broadcast(-1.0f), view[2]));
+}
+
+}
+
+CanvasPoint projectVertex(const Projection &projection, glm::vec3 position) {
+	glm::vec3 relative = position - projection.cameraPosition;
+	glm::vec3 view;
+	for (int axis = 0; axis < 3; axis++) {
+		const glm::vec3 &direction = projection.orientation[axis];
+		view[axis] = relative.x * direction.x + relative.y * direction.y + relative.z * direction.z;
+	}
+	float u = -projection.focalLength * (view.x / view.z) * projection.imagePlaneScale + projection.canvasWidth / 2.0f;
+	float v = projection.focalLength * (view.y / view.z) * projection.imagePlaneScale + projection.canvasHeight / 2.0f;
+	return CanvasPoint(u, v, -1.0f / view.z);
+}
+
+void projectVertices(const Projection &projection, const glm::vec3 *positions, size_t count, ProjectedVertices &projected) {
+	const size_t laneCount = lanes::LANE_COUNT;
+	size_t padded = (count + laneCount - 1) / laneCount * laneCount;
+	projected.x.resize(padded);
+	projected.y.resize(padded);
+	projected.depth.resize(padded);
+	projected.count = count;
+	size_t whole = count / laneCount * laneCount;
+	for (size_t v = 0; v < whole; v += laneCount) {
+		projectBlock(projection, &positions[v].x, &projected.x[v], &projected.y[v], &projected.depth[v]);
+	}
+	if (whole == count) return;
+	// the last partial block is copied out so the loads don't run off the end, with the spare lanes a unit in
+	// front of the camera so they don't divide by zero
+	glm::vec3 tail[lanes::LANE_COUNT];
+	std::fill(tail, tail + laneCount, projection.cameraPosition - projection.orientation[2]);
+	std::copy(positions + whole, positions + count, tail);
+	projectBlock(projection, &tail[0].x, &projected.x[whole], &projected.y[whole], &projected.depth[whole]);
+}
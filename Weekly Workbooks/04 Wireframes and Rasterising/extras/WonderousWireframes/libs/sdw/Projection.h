@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "CanvasPoint.h"
+
+// A pinhole camera and the canvas it projects onto. The columns of orientation are the camera's right, up and
+// backward axes in world space, so it looks along -orientation[2].
+struct Projection {
+	glm::vec3 cameraPosition;
+	glm::mat3 orientation;
+	float focalLength;
+	// canvas pixels per unit of the image plane
+	float imagePlaneScale;
+	float canvasWidth;
+	float canvasHeight;
+};
+
+// Projected vertices, one array per coordinate. Each array is padded to a whole number of SIMD blocks.
+struct ProjectedVertices {
+	std::vector<float> x;
+	std::vector<float> y;
+	// 1/z, as CanvasPoint depth holds it, so nearer points have the larger value
+	std::vector<float> depth;
+	size_t count = 0;
+
+	CanvasPoint point(size_t index) const {
+		return CanvasPoint(x[index], y[index], depth[index]);
+	}
+};
+
+// Points behind the camera come out as nonsense, so anything reaching behind the near plane must be clipped
+// before it's projected
+CanvasPoint projectVertex(const Projection &projection, glm::vec3 position);
+// The same for a whole array at once, a block of vertices per instruction. Gives what projectVertex would
+// for each, bar the last bit where the compiler fuses multiplies and adds (with FMA) differently in the two, so
+// points that have to meet exactly (the corners neighbouring triangles share) must all go through the same one.
+void projectVertices(const Projection &projection, const glm::vec3 *positions, size_t count, ProjectedVertices &projected);
@@ -0,0 +1,465 @@
+#include "Rasteriser.h"
+#include <algorithm>
+#include <cmath>
+#include "Clipper.h"
+#include "SimdLanes.h"
+
+namespace {
+
+// Coverage is decided on vertex positions snapped to 28.4 fixed point, 16 steps to a pixel, with exact
+// integer edge functions, so two triangles sharing an edge always agree on which pixels are whose
+const int SUBPIXEL_BITS = 4;
+const int64_t SUBPIXEL_ONE = int64_t(1) << SUBPIXEL_BITS;
+const int64_t SUBPIXEL_HALF = SUBPIXEL_ONE / 2;
+// Vertices further out than this (in pixels) are rejected rather than snapped; the guard band keeps real ones well inside
+const float MAX_COORDINATE = float(1 << 20);
+// Integers up to this size survive conversion to float exactly, with room to spare for adding the per-lane steps
+const int64_t EXACT_FLOAT_LIMIT = int64_t(1) << 23;
+
+EdgeFunction makeEdge(const CanvasPoint &from, const CanvasPoint &to) {
+	EdgeFunction edge{};
+	edge.a = from.y - to.y;
+	edge.b = to.x - from.x;
+	edge.c = -(edge.a * from.x + edge.b * from.y);
+	return edge;
+}
+
+// Top-left fill rule: a sample lying exactly on an edge belongs to the triangle only if that edge is a left
+// edge (the inside is to its right) or a flat top edge (the inside is below it). Any other edge gives up
+// its samples to the neighbour on the other side, so no pixel is drawn twice and none is missed.
+FixedEdge makeFixedEdge(int64_t fromX, int64_t fromY, int64_t toX, int64_t toY) {
+	FixedEdge edge{};
+	edge.a = fromY - toY;
+	edge.b = toX - fromX;
+	edge.c = -(edge.a * fromX + edge.b * fromY);
+	bool topLeft = edge.a > 0 || (edge.a == 0 && edge.b > 0);
+	if (!topLeft) edge.c -= 1;
+	return edge;
+}
+
+int64_t floorDivide(int64_t numerator, int64_t denominator) {
+	int64_t quotient = numerator / denominator;
+	return (numerator % denominator != 0 && (numerator < 0) != (denominator < 0)) ? quotient - 1 : quotient;
+}
+
+// The plane through the three (wound) vertices' values of some attribute, as a function of screen position
+EdgeFunction interpolationPlane(const TriangleSetup &setup, float value0, float value1, float value2) {
+	const float weights[3] = {value0 / setup.area, value1 / setup.area, value2 / setup.area};
+	EdgeFunction plane{0.0f, 0.0f, 0.0f};
+	for (int i = 0; i < 3; i++) {
+		plane.a += setup.edges[i].a * weights[i];
+		plane.b += setup.edges[i].b * weights[i];
+		plane.c += setup.edges[i].c * weights[i];
+	}
+	return plane;
+}
+
+// The setup with its pixel bounds cut down to clip, false if that leaves none
+bool clippedSetup(const TriangleSetup &setup, const ClipRect &clip, TriangleSetup &clipped) {
+	clipped = setup;
+	clipped.minX = std::max(setup.minX, clip.minX);
+	clipped.maxX = std::min(setup.maxX, clip.maxX);
+	clipped.minY = std::max(setup.minY, clip.minY);
+	clipped.maxY = std::min(setup.maxY, clip.maxY);
+	return clipped.minX <= clipped.maxX && clipped.minY <= clipped.maxY;
+}
+
+}
+
+bool setUpTriangle(const CanvasTriangle &triangle, const ClipRect &clip, TriangleSetup &setup) {
+	CanvasPoint v[3] = {triangle[0], triangle[1], triangle[2]};
+	int64_t x[3], y[3];
+	for (int i = 0; i < 3; i++) {
+		// written so that NaN is rejected too
+		if (!(std::fabs(v[i].x) <= MAX_COORDINATE && std::fabs(v[i].y) <= MAX_COORDINATE)) return false;
+		x[i] = std::llround(v[i].x * float(SUBPIXEL_ONE));
+		y[i] = std::llround(v[i].y * float(SUBPIXEL_ONE));
+	}
+	int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+	if (area == 0) return false;
+	// wind the triangle so that the inside is on the positive side of every edge
+	if (area < 0) {
+		std::swap(v[1], v[2]);
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		area = -area;
+	}
+
+	// pixel n's sample sits at n * SUBPIXEL_ONE + SUBPIXEL_HALF, so these are the first and last pixels whose
+	// samples fall inside the bounding box
+	int64_t left = floorDivide(std::min({x[0], x[1], x[2]}) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1, SUBPIXEL_ONE);
+	int64_t right = floorDivide(std::max({x[0], x[1], x[2]}) - SUBPIXEL_HALF, SUBPIXEL_ONE);
+	int64_t top = floorDivide(std::min({y[0], y[1], y[2]}) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1, SUBPIXEL_ONE);
+	int64_t bottom = floorDivide(std::max({y[0], y[1], y[2]}) - SUBPIXEL_HALF, SUBPIXEL_ONE);
+	setup.minX = int(std::max<int64_t>(left, clip.minX));
+	setup.maxX = int(std::min<int64_t>(right, clip.maxX));
+	setup.minY = int(std::max<int64_t>(top, clip.minY));
+	setup.maxY = int(std::min<int64_t>(bottom, clip.maxY));
+	if (setup.minX > setup.maxX || setup.minY > setup.maxY) return false;
+
+	int64_t steepest = 0;
+	for (int i = 0; i < 3; i++) {
+		int next = (i + 1) % 3;
+		int opposite = (i + 2) % 3;
+		setup.fixedEdges[opposite] = makeFixedEdge(x[i], y[i], x[next], y[next]);
+		steepest = std::max(steepest, std::abs(setup.fixedEdges[opposite].a));
+		setup.laneSteps[opposite] = float(setup.fixedEdges[opposite].a * SUBPIXEL_ONE);
+		// interpolate from where the vertices were snapped to, so attributes line up with coverage
+		v[i].x = float(x[i]) / float(SUBPIXEL_ONE);
+		v[i].y = float(y[i]) / float(SUBPIXEL_ONE);
+	}
+	setup.exactLanes = steepest * SUBPIXEL_ONE * (lanes::LANE_COUNT - 1) < EXACT_FLOAT_LIMIT;
+
+	for (int i = 0; i < 3; i++) setup.vertices[i] = v[i];
+	setup.area = float(area) / float(SUBPIXEL_ONE * SUBPIXEL_ONE);
+	setup.edges[0] = makeEdge(v[1], v[2]);
+	setup.edges[1] = makeEdge(v[2], v[0]);
+	setup.edges[2] = makeEdge(v[0], v[1]);
+	setup.depth = interpolationPlane(setup, v[0].depth, v[1].depth, v[2].depth);
+	setup.nearestDepth = std::max({v[0].depth, v[1].depth, v[2].depth});
+	return true;
+}
+
+namespace {
+
+// The edge functions at a row's samples, less the part that depends on x
+struct RowTerms {
+	float edges[3];
+	int64_t fixedEdges[3];
+};
+
+void computeRowTerms(const TriangleSetup &setup, int y, RowTerms &row) {
+	float centreY = float(y) + 0.5f;
+	int64_t sampleY = int64_t(y) * SUBPIXEL_ONE + SUBPIXEL_HALF;
+	for (int i = 0; i < 3; i++) {
+		row.edges[i] = setup.edges[i].b * centreY + setup.edges[i].c;
+		row.fixedEdges[i] = setup.fixedEdges[i].b * sampleY + setup.fixedEdges[i].c;
+	}
+}
+
+bool coversPixel(const TriangleSetup &setup, const RowTerms &row, int x) {
+	int64_t sampleX = int64_t(x) * SUBPIXEL_ONE + SUBPIXEL_HALF;
+	for (int i = 0; i < 3; i++) {
+		if (setup.fixedEdges[i].a * sampleX + row.fixedEdges[i] < 0) return false;
+	}
+	return true;
+}
+
+// Each block covers the pixels [blockX, blockX + LANE_COUNT) of a row. The edges are evaluated exactly in
+// integers at the block's first sample; the lanes then only add multiples of a single step, which floats hold
+// exactly once the block's value is clamped to EXACT_FLOAT_LIMIT (a value that large can't change sign within
+// the block). Triangles too steep for that fall back to testing pixel by pixel.
+lanes::Mask coverage(int blockX, const RowTerms &row, const TriangleSetup &setup) {
+	lanes::Floats x = lanes::pixelCentres(blockX);
+	lanes::Mask inside = lanes::both(lanes::greaterEqual(x, lanes::broadcast(float(setup.minX) + 0.5f)),
+	                                 lanes::lessEqual(x, lanes::broadcast(float(setup.maxX) + 0.5f)));
+	if (!setup.exactLanes) {
+		int covered = 0;
+		for (int lane = 0; lane < lanes::LANE_COUNT; lane++) covered |= int(coversPixel(setup, row, blockX + lane)) << lane;
+		return lanes::both(inside, lanes::fromBits(covered));
+	}
+	lanes::Floats zero = lanes::broadcast(0.0f);
+	int64_t sampleX = int64_t(blockX) * SUBPIXEL_ONE + SUBPIXEL_HALF;
+	for (int i = 0; i < 3; i++) {
+		int64_t atBlock = setup.fixedEdges[i].a * sampleX + row.fixedEdges[i];
+		atBlock = std::max(-EXACT_FLOAT_LIMIT, std::min(EXACT_FLOAT_LIMIT, atBlock));
+		lanes::Floats e = lanes::add(lanes::broadcast(float(atBlock)), lanes::mul(lanes::broadcast(setup.laneSteps[i]), lanes::laneIndices()));
+		inside = lanes::both(inside, lanes::greaterEqual(e, zero));
+	}
+	return inside;
+}
+
+void fillBlock(uint32_t *pixels, int blockX, const RowTerms &row, const TriangleSetup &setup, uint32_t colour) {
+	lanes::Mask inside = coverage(blockX, row, setup);
+	if (lanes::bits(inside) != 0) lanes::storePixels(pixels, inside, colour);
+}
+
+bool fillDepthTestedBlock(uint32_t *pixels, float *depths, int blockX, const RowTerms &row, float depthRowTerm,
+                          const TriangleSetup &setup, uint32_t colour) {
+	lanes::Mask inside = coverage(blockX, row, setup);
+	if (lanes::bits(inside) == 0) return false;
+	lanes::Floats x = lanes::pixelCentres(blockX);
+	lanes::Floats depth = lanes::add(lanes::mul(lanes::broadcast(setup.depth.a), x), lanes::broadcast(depthRowTerm));
+	lanes::Floats existing = lanes::load(depths);
+	// the largest 1/z is the nearest surface, so that is the one that wins
+	inside = lanes::both(inside, lanes::greaterThan(depth, existing));
+	if (lanes::bits(inside) == 0) return false;
+	lanes::store(depths, lanes::select(inside, depth, existing));
+	lanes::storePixels(pixels, inside, colour);
+	return true;
+}
+
+// Finds the run of pixels the triangle covers on a row by solving each edge for x, then settles any
+// rounding at the ends with the same exact per-pixel test the block rasteriser uses
+bool coveredSpan(const TriangleSetup &setup, const RowTerms &row, int &first, int &last) {
+	float lowest = float(setup.minX);
+	float highest = float(setup.maxX);
+	for (int i = 0; i < 3; i++) {
+		float a = setup.edges[i].a;
+		if (a > 0.0f) lowest = std::max(lowest, std::ceil(-row.edges[i] / a - 0.5f));
+		else if (a < 0.0f) highest = std::min(highest, std::floor(-row.edges[i] / a - 0.5f));
+		else if (row.fixedEdges[i] < 0) return false;
+	}
+	if (!(lowest <= highest)) return false;
+	first = int(lowest);
+	last = int(highest);
+	while (first <= last && !coversPixel(setup, row, first)) first++;
+	while (last >= first && !coversPixel(setup, row, last)) last--;
+	if (first > last) return false;
+	while (first > setup.minX && coversPixel(setup, row, first - 1)) first--;
+	while (last < setup.maxX && coversPixel(setup, row, last + 1)) last++;
+	return true;
+}
+
+// The nearest 1/z the triangle can reach anywhere in the rectangle (the plane peaks at one of its corners)
+float nearestDepthInRect(const TriangleSetup &setup, float left, float top, float right, float bottom) {
+	float x = setup.depth.a > 0.0f ? right : left;
+	float y = setup.depth.b > 0.0f ? bottom : top;
+	return std::min(setup.nearestDepth, setup.depth.a * x + setup.depth.b * y + setup.depth.c);
+}
+// Fills the pixels within the setup's bounds
+void fillSetUp(const FramebufferView &target, const TriangleSetup &setup, uint32_t colour) {
+	int width = int(target.width);
+	int firstBlock = setup.minX - (setup.minX % lanes::LANE_COUNT);
+	for (int y = setup.minY; y <= setup.maxY; y++) {
+		RowTerms rowTerms;
+		computeRowTerms(setup, y, rowTerms);
+		uint32_t *row = target.row(y);
+		for (int blockX = firstBlock; blockX <= setup.maxX; blockX += lanes::LANE_COUNT) {
+			if (blockX + lanes::LANE_COUNT <= width) {
+				fillBlock(row + blockX, blockX, rowTerms, setup, colour);
+			} else {
+				// the last block hangs off the end of the row, so shade a copy of it instead
+				uint32_t spill[lanes::LANE_COUNT] = {};
+				std::copy(row + blockX, row + width, spill);
+				fillBlock(spill, blockX, rowTerms, setup, colour);
+				std::copy(spill, spill + (width - blockX), row + blockX);
+			}
+		}
+	}
+}
+
+void fillDepthTestedSetUp(const FramebufferView &target, DepthBuffer &depthBuffer, const TriangleSetup &setup, uint32_t colour) {
+	const int tileSize = DepthBuffer::TILE_SIZE;
+	int width = int(target.width);
+	for (int tileY = setup.minY / tileSize; tileY <= setup.maxY / tileSize; tileY++) {
+		int firstY = std::max(setup.minY, tileY * tileSize);
+		int lastY = std::min(setup.maxY, tileY * tileSize + tileSize - 1);
+		for (int tileX = setup.minX / tileSize; tileX <= setup.maxX / tileSize; tileX++) {
+			int firstX = std::max(setup.minX, tileX * tileSize);
+			int lastX = std::min(setup.maxX, tileX * tileSize + tileSize - 1);
+			float nearest = nearestDepthInRect(setup, float(firstX), float(firstY), float(lastX + 1), float(lastY + 1));
+			// Hi-Z: everything already drawn in this tile is in front of this triangle, so skip the whole tile
+			if (depthBuffer.isTileOccluded(tileX, tileY, nearest)) continue;
+			depthBuffer.prepareTile(tileX, tileY);
+
+			bool written = false;
+			int firstBlock = firstX - (firstX % lanes::LANE_COUNT);
+			for (int y = firstY; y <= lastY; y++) {
+				RowTerms rowTerms;
+				computeRowTerms(setup, y, rowTerms);
+				float depthRowTerm = setup.depth.b * (float(y) + 0.5f) + setup.depth.c;
+				uint32_t *row = target.row(y);
+				float *depths = depthBuffer.rowPointer(y);
+				for (int blockX = firstBlock; blockX <= lastX; blockX += lanes::LANE_COUNT) {
+					if (blockX + lanes::LANE_COUNT <= width) {
+						written |= fillDepthTestedBlock(row + blockX, depths + blockX, blockX, rowTerms, depthRowTerm, setup, colour);
+					} else {
+						uint32_t spill[lanes::LANE_COUNT] = {};
+						std::copy(row + blockX, row + width, spill);
+						written |= fillDepthTestedBlock(spill, depths + blockX, blockX, rowTerms, depthRowTerm, setup, colour);
+						std::copy(spill, spill + (width - blockX), row + blockX);
+					}
+				}
+			}
+			if (written) depthBuffer.updateTile(tileX, tileY);
+		}
+	}
+}
+
+// How a triangle's texture coordinates vary across the screen
+struct TextureSetup {
+	// u and v, or u/z and v/z with perspective
+	EdgeFunction u;
+	EdgeFunction v;
+	bool perspective;
+	// Without perspective the texture coordinates' derivatives are the planes' slopes, the same everywhere
+	float affineFootprint;
+};
+
+TextureSetup setUpTexture(const TriangleSetup &setup, const TextureSampler &sampler) {
+	const CanvasPoint *v = setup.vertices;
+	TextureSetup texture{};
+	// perspective needs a 1/z at every vertex, which flat canvas triangles don't have
+	texture.perspective = sampler.perspectiveCorrect && v[0].depth > 0.0f && v[1].depth > 0.0f && v[2].depth > 0.0f;
+	if (texture.perspective) {
+		texture.u = interpolationPlane(setup, v[0].texturePoint.x * v[0].depth, v[1].texturePoint.x * v[1].depth, v[2].texturePoint.x * v[2].depth);
+		texture.v = interpolationPlane(setup, v[0].texturePoint.y * v[0].depth, v[1].texturePoint.y * v[1].depth, v[2].texturePoint.y * v[2].depth);
+	} else {
+		texture.u = interpolationPlane(setup, v[0].texturePoint.x, v[1].texturePoint.x, v[2].texturePoint.x);
+		texture.v = interpolationPlane(setup, v[0].texturePoint.y, v[1].texturePoint.y, v[2].texturePoint.y);
+	}
+	const EdgeFunction &uPlane = texture.u, &vPlane = texture.v;
+	texture.affineFootprint = std::sqrt(std::max(uPlane.a * uPlane.a + vPlane.a * vPlane.a, uPlane.b * uPlane.b + vPlane.b * vPlane.b));
+	return texture;
+}
+
+// Samples the texels of pixels first to last of row y into destination, one after another
+void sampleRow(const TriangleSetup &setup, const TextureSetup &texture, const TextureSampler &sampler, int y, int first, int last, uint32_t *destination) {
+	const EdgeFunction &uPlane = texture.u;
+	const EdgeFunction &vPlane = texture.v;
+	float centreY = float(y) + 0.5f;
+	float uRow = uPlane.b * centreY + uPlane.c;
+	float vRow = vPlane.b * centreY + vPlane.c;
+	if (!texture.perspective) {
+		// u and v are affine along the row, so one fixed point step per pixel covers the whole span
+		float startX = float(first) + 0.5f;
+		sampler.sampleSpan(destination, last - first + 1,
+		                   toFixedPoint(uPlane.a * startX + uRow), toFixedPoint(vPlane.a * startX + vRow),
+		                   toFixedPoint(uPlane.a), toFixedPoint(vPlane.a), texture.affineFootprint);
+		return;
+	}
+	// Perspective: divide by 1/z at the ends of every PERSPECTIVE_STEP pixels and step linearly in between
+	const int PERSPECTIVE_STEP = 8;
+	float depthRow = setup.depth.b * centreY + setup.depth.c;
+	auto textureAt = [&](float x, float &u, float &v) {
+		float depth = setup.depth.a * x + depthRow;
+		u = (uPlane.a * x + uRow) / depth;
+		v = (vPlane.a * x + vRow) / depth;
+	};
+	// By the quotient rule, d(u)/dx = (d(u/z)/dx - u d(1/z)/dx) / (1/z), and likewise for v and y
+	auto footprintAt = [&](float x, float u, float v) {
+		float depth = setup.depth.a * x + depthRow;
+		float dudx = uPlane.a - u * setup.depth.a, dvdx = vPlane.a - v * setup.depth.a;
+		float dudy = uPlane.b - u * setup.depth.b, dvdy = vPlane.b - v * setup.depth.b;
+		return std::sqrt(std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy)) / depth;
+	};
+	bool mipmapped = sampler.mipmapped();
+	float u0, v0;
+	textureAt(float(first) + 0.5f, u0, v0);
+	for (int start = first; start <= last; start += PERSPECTIVE_STEP) {
+		int count = std::min(PERSPECTIVE_STEP, last - start + 1);
+		float u1, v1;
+		textureAt(float(start + count) + 0.5f, u1, v1);
+		sampler.sampleSpan(destination + (start - first), count, toFixedPoint(u0), toFixedPoint(v0),
+		                   toFixedPoint((u1 - u0) / float(count)), toFixedPoint((v1 - v0) / float(count)),
+		                   mipmapped ? footprintAt(float(start) + 0.5f, u0, v0) : 1.0f);
+		u0 = u1;
+		v0 = v1;
+	}
+}
+
+// Fills the pixels within the setup's bounds
+void fillTexturedSetUp(const FramebufferView &target, const TriangleSetup &setup, const TextureSampler &sampler) {
+	TextureSetup texture = setUpTexture(setup, sampler);
+	for (int y = setup.minY; y <= setup.maxY; y++) {
+		RowTerms rowTerms;
+		computeRowTerms(setup, y, rowTerms);
+		int first, last;
+		if (coveredSpan(setup, rowTerms, first, last)) sampleRow(setup, texture, sampler, y, first, last, target.row(y) + first);
+	}
+}
+
+// As fillDepthTestedSetUp, but each row's covered pixels are sampled first and then depth tested one by one
+void fillDepthTestedTexturedSetUp(const FramebufferView &target, DepthBuffer &depthBuffer, const TriangleSetup &setup, const TextureSampler &sampler) {
+	const int tileSize = DepthBuffer::TILE_SIZE;
+	TextureSetup texture = setUpTexture(setup, sampler);
+	for (int tileY = setup.minY / tileSize; tileY <= setup.maxY / tileSize; tileY++) {
+		int firstY = std::max(setup.minY, tileY * tileSize);
+		int lastY = std::min(setup.maxY, tileY * tileSize + tileSize - 1);
+		for (int tileX = setup.minX / tileSize; tileX <= setup.maxX / tileSize; tileX++) {
+			int firstX = std::max(setup.minX, tileX * tileSize);
+			int lastX = std::min(setup.maxX, tileX * tileSize + tileSize - 1);
+			float nearest = nearestDepthInRect(setup, float(firstX), float(firstY), float(lastX + 1), float(lastY + 1));
+			if (depthBuffer.isTileOccluded(tileX, tileY, nearest)) continue;
+			depthBuffer.prepareTile(tileX, tileY);
+
+			bool written = false;
+			for (int y = firstY; y <= lastY; y++) {
+				RowTerms rowTerms;
+				computeRowTerms(setup, y, rowTerms);
+				int first, last;
+				if (!coveredSpan(setup, rowTerms, first, last)) continue;
+				first = std::max(first, firstX);
+				last = std::min(last, lastX);
+				if (first > last) continue;
+				uint32_t texels[tileSize];
+				sampleRow(setup, texture, sampler, y, first, last, texels);
+				float depthRowTerm = setup.depth.b * (float(y) + 0.5f) + setup.depth.c;
+				uint32_t *row = target.row(y);
+				float *depths = depthBuffer.rowPointer(y);
+				for (int x = first; x <= last; x++) {
+					float depth = setup.depth.a * (float(x) + 0.5f) + depthRowTerm;
+					if (depth <= depths[x]) continue;
+					depths[x] = depth;
+					row[x] = texels[x - first];
+					written = true;
+				}
+			}
+			if (written) depthBuffer.updateTile(tileX, tileY);
+		}
+	}
+}
+
+void fillTexturedWithinGuardBand(const FramebufferView &target, const CanvasTriangle &triangle, const TextureSampler &sampler, const ClipRect &clip) {
+	TriangleSetup setup{};
+	if (setUpTriangle(triangle, clip, setup)) fillTexturedSetUp(target, setup, sampler);
+}
+
+}
+
+void fillTriangle(const FramebufferView &target, const CanvasTriangle &triangle, uint32_t colour) {
+	fillTriangle(target, triangle, colour, ClipRect{0, 0, int(target.width) - 1, int(target.height) - 1});
+}
+
+void fillTriangle(const FramebufferView &target, const CanvasTriangle &triangle, uint32_t colour, const ClipRect &clip) {
+	CanvasTriangle pieces[MAX_GUARD_BAND_CLIPPED_TRIANGLES];
+	int count = clipToGuardBand(triangle, float(target.width), float(target.height), pieces);
+	for (int i = 0; i < count; i++) {
+		TriangleSetup setup{};
+		if (setUpTriangle(pieces[i], clip, setup)) fillSetUp(target, setup, colour);
+	}
+}
+
+void fillTriangle(const FramebufferView &target, const TriangleSetup &setup, uint32_t colour, const ClipRect &clip) {
+	TriangleSetup clipped;
+	if (clippedSetup(setup, clip, clipped)) fillSetUp(target, clipped, colour);
+}
+
+void fillTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const CanvasTriangle &triangle, uint32_t colour) {
+	fillTriangle(target, depthBuffer, triangle, colour, ClipRect{0, 0, int(target.width) - 1, int(target.height) - 1});
+}
+
+void fillTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const CanvasTriangle &triangle, uint32_t colour, const ClipRect &clip) {
+	CanvasTriangle pieces[MAX_GUARD_BAND_CLIPPED_TRIANGLES];
+	int count = clipToGuardBand(triangle, float(target.width), float(target.height), pieces);
+	for (int i = 0; i < count; i++) {
+		TriangleSetup setup{};
+		if (setUpTriangle(pieces[i], clip, setup)) fillDepthTestedSetUp(target, depthBuffer, setup, colour);
+	}
+}
+
+void fillTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const TriangleSetup &setup, uint32_t colour, const ClipRect &clip) {
+	TriangleSetup clipped;
+	if (clippedSetup(setup, clip, clipped)) fillDepthTestedSetUp(target, depthBuffer, clipped, colour);
+}
+
+void fillTexturedTriangle(const FramebufferView &target, const CanvasTriangle &triangle, const TextureSampler &sampler) {
+	fillTexturedTriangle(target, triangle, sampler, ClipRect{0, 0, int(target.width) - 1, int(target.height) - 1});
+}
+
+void fillTexturedTriangle(const FramebufferView &target, const CanvasTriangle &triangle, const TextureSampler &sampler, const ClipRect &clip) {
+	CanvasTriangle pieces[MAX_GUARD_BAND_CLIPPED_TRIANGLES];
+	int count = clipToGuardBand(triangle, float(target.width), float(target.height), pieces);
+	for (int i = 0; i < count; i++) fillTexturedWithinGuardBand(target, pieces[i], sampler, clip);
+}
+
+void fillTexturedTriangle(const FramebufferView &target, const TriangleSetup &setup, const TextureSampler &sampler, const ClipRect &clip) {
+	TriangleSetup clipped;
+	if (clippedSetup(setup, clip, clipped)) fillTexturedSetUp(target, clipped, sampler);
+}
+
+void fillTexturedTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const TriangleSetup &setup, const TextureSampler &sampler, const ClipRect &clip) {
+	TriangleSetup clipped;
+	if (clippedSetup(setup, clip, clipped)) fillDepthTestedTexturedSetUp(target, depthBuffer, clipped, sampler);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include "CanvasTriangle.h"
+#include "DepthBuffer.h"
+#include "FramebufferView.h"
+#include "TextureSampler.h"
+
+// Inclusive pixel bounds that drawing is restricted to
+struct ClipRect {
+	int minX;
+	int minY;
+	int maxX;
+	int maxY;
+};
+
+// E(x, y) = a*x + b*y + c, which is positive on the inside of the edge (once the triangle is wound consistently)
+struct EdgeFunction {
+	float a;
+	float b;
+	float c;
+};
+
+// The same, over 28.4 sample positions, and biased so that a sample is covered exactly when every edge is >= 0
+struct FixedEdge {
+	int64_t a;
+	int64_t b;
+	int64_t c;
+};
+
+// A triangle ready to rasterise: snapped, wound, with its edge functions and depth plane worked out and its
+// pixel bounds found. Setting up is the costly part of a small triangle, so one drawn a piece at a time (a
+// tile, say) is best set up once and then filled against each piece's ClipRect.
+struct TriangleSetup {
+	// the triangle's vertices, snapped to the sub-pixel grid and wound so that area is positive
+	CanvasPoint vertices[3];
+	float area;
+	// edges[i] is the edge opposite vertex i, so it also acts as that vertex's (unnormalised) barycentric weight.
+	// These are only used for interpolating, coverage comes from fixedEdges.
+	EdgeFunction edges[3];
+	FixedEdge fixedEdges[3];
+	// how much each fixed edge changes from one pixel to the next, as a float
+	float laneSteps[3];
+	// whether every lane of a SIMD block can be tested in float without rounding
+	bool exactLanes;
+	// 1/z across the triangle, which is affine in screen space
+	EdgeFunction depth;
+	float nearestDepth;
+	int minX;
+	int maxX;
+	int minY;
+	int maxY;
+};
+
+// Half-space rasteriser: walks the triangle's bounding box testing the three edge functions
+// at each pixel centre, a whole SIMD block (8 pixels with AVX, 4 with SSE2) at a time.
+// Vertices are snapped to 28.4 fixed point and edges follow the top-left fill rule, so every pixel of a
+// mesh is drawn exactly once. Triangles reaching past the guard band are clipped to it first.
+void fillTriangle(const FramebufferView &target, const CanvasTriangle &triangle, uint32_t colour);
+// As above, but only touches pixels inside clip (which must lie within the target)
+void fillTriangle(const FramebufferView &target, const CanvasTriangle &triangle, uint32_t colour, const ClipRect &clip);
+// Depth-tested versions: each vertex's depth holds its 1/z, and a pixel is only drawn where the triangle is
+// nearer than what depthBuffer already holds. Tiles the buffer's coarse level proves hidden are skipped outright.
+void fillTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const CanvasTriangle &triangle, uint32_t colour);
+void fillTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const CanvasTriangle &triangle, uint32_t colour, const ClipRect &clip);
+// The triangle must already be within the guard band (see clipToGuardBand). Returns false if it covers no
+// pixel inside clip.
+bool setUpTriangle(const CanvasTriangle &triangle, const ClipRect &clip, TriangleSetup &setup);
+// Fill a triangle set up beforehand, only touching pixels inside clip (as well as the setup's bounds)
+void fillTriangle(const FramebufferView &target, const TriangleSetup &setup, uint32_t colour, const ClipRect &clip);
+void fillTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const TriangleSetup &setup, uint32_t colour, const ClipRect &clip);
+// Textured versions: each vertex's texturePoint gives its position in the sampler's texture, in texels. The
+// footprint the sampler picks mip levels by is worked out per span (every few pixels with perspective).
+void fillTexturedTriangle(const FramebufferView &target, const CanvasTriangle &triangle, const TextureSampler &sampler);
+void fillTexturedTriangle(const FramebufferView &target, const CanvasTriangle &triangle, const TextureSampler &sampler, const ClipRect &clip);
+void fillTexturedTriangle(const FramebufferView &target, const TriangleSetup &setup, const TextureSampler &sampler, const ClipRect &clip);
+void fillTexturedTriangle(const FramebufferView &target, DepthBuffer &depthBuffer, const TriangleSetup &setup, const TextureSampler &sampler, const ClipRect &clip);
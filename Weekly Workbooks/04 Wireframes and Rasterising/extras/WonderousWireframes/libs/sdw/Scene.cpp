@@ -0,0 +1,129 @@
+#include "Scene.h"
+#include <atomic>
+#include <limits>
+#include <utility>
+
+namespace {
+
+std::atomic<uint64_t> lastVersion{0};
+
+}
+
+glm::vec3 Transform::apply(glm::vec3 point) const {
+	return rotation * point + translation;
+}
+
+Transform Transform::then(const Transform &other) const {
+	// built field by field, as the member initialisers stop Transform being an aggregate before C++14
+	Transform combined;
+	combined.rotation = other.rotation * rotation;
+	combined.translation = other.rotation * translation + other.translation;
+	return combined;
+}
+
+glm::vec3 Transform::toLocal(glm::vec3 worldPoint) const {
+	// a rotation's inverse is its transpose
+	return glm::transpose(rotation) * (worldPoint - translation);
+}
+
+glm::vec4 Transform::planeToLocal(const glm::vec4 &worldPlane) const {
+	glm::vec3 normal(worldPlane);
+	return glm::vec4(glm::transpose(rotation) * normal, worldPlane.w + glm::dot(normal, translation));
+}
+
+Frustum Transform::frustumToLocal(const Frustum &worldFrustum) const {
+	Frustum local;
+	for (int i = 0; i < Frustum::PLANE_COUNT; i++) local.planes[i] = planeToLocal(worldFrustum.planes[i]);
+	return local;
+}
+
+Projection Transform::projectionToLocal(const Projection &worldProjection) const {
+	Projection local = worldProjection;
+	local.cameraPosition = toLocal(worldProjection.cameraPosition);
+	local.orientation = glm::transpose(rotation) * worldProjection.orientation;
+	return local;
+}
+
+const size_t Scene::NO_PART;
+
+Scene::Scene(Mesh mesh) : sceneMesh(std::move(mesh)), sceneVersion(++lastVersion) {
+	nodes.push_back(SceneNode{"", -1, sceneMesh.parts.size() + 1, NO_PART, Transform(), Transform(), glm::vec3(), glm::vec3(), 0});
+	for (size_t p = 0; p < sceneMesh.parts.size(); p++) {
+		nodes.push_back(SceneNode{sceneMesh.parts[p].name, 0, nodes.size() + 1, p, Transform(), Transform(), glm::vec3(), glm::vec3(), 0});
+	}
+	update();
+}
+
+const Mesh &Scene::mesh() const {
+	return sceneMesh;
+}
+
+size_t Scene::nodeCount() const {
+	return nodes.size();
+}
+
+const SceneNode &Scene::node(size_t index) const {
+	return nodes[index];
+}
+
+int Scene::find(const std::string &name) const {
+	for (size_t n = 0; n < nodes.size(); n++) {
+		if (nodes[n].name == name) return int(n);
+	}
+	return -1;
+}
+
+uint64_t Scene::version() const {
+	return sceneVersion;
+}
+
+void Scene::setTransform(size_t index, const Transform &local) {
+	nodes[index].local = local;
+	update();
+	sceneVersion = ++lastVersion;
+}
+
+void Scene::update() {
+	// parents come before their children, so each world transform only needs its parent's
+	for (SceneNode &node : nodes) {
+		node.world = node.parent < 0 ? node.local : node.local.then(nodes[size_t(node.parent)].world);
+		node.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+		node.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+		node.subtreeTriangleCount = 0;
+		if (node.part == NO_PART) continue;
+		const MeshPart &part = sceneMesh.parts[node.part];
+		node.subtreeTriangleCount = part.triangleCount;
+		if (part.vertexCount == 0) continue;
+		// the box around the turned box: its half extents along each world axis are the absolute rotation's
+		glm::vec3 centre = node.world.apply((part.boundsMin + part.boundsMax) * 0.5f);
+		glm::vec3 halfSize = (part.boundsMax - part.boundsMin) * 0.5f;
+		glm::vec3 extent(0.0f);
+		for (int column = 0; column < 3; column++) extent += glm::abs(node.world.rotation[column]) * halfSize[column];
+		node.boundsMin = centre - extent;
+		node.boundsMax = centre + extent;
+	}
+	// and children after, so going backwards gathers each subtree into its parent
+	for (size_t n = nodes.size(); n-- > 1;) {
+		SceneNode &parent = nodes[size_t(nodes[n].parent)];
+		parent.boundsMin = glm::min(parent.boundsMin, nodes[n].boundsMin);
+		parent.boundsMax = glm::max(parent.boundsMax, nodes[n].boundsMax);
+		parent.subtreeTriangleCount += nodes[n].subtreeTriangleCount;
+	}
+}
+
+CullStats cullNodes(const Scene &scene, const Frustum &frustum, std::vector<uint32_t> &visibleNodes) {
+	CullStats stats;
+	visibleNodes.clear();
+	for (size_t n = 0; n < scene.nodeCount();) {
+		const SceneNode &node = scene.node(n);
+		if (node.subtreeTriangleCount == 0 || isOutsideFrustum(node.boundsMin, node.boundsMax, frustum)) {
+			stats.outsideFrustum += node.subtreeTriangleCount;
+			if (node.subtreeTriangleCount != 0) stats.culledObjects++;
+			n = node.subtreeEnd;
+			continue;
+		}
+		if (node.part != Scene::NO_PART) visibleNodes.push_back(uint32_t(n));
+		n++;
+	}
+	return stats;
+}
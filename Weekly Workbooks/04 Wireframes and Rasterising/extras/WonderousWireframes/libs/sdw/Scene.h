@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.h"
+#include "Culling.h"
+#include "Mesh.h"
+#include "Projection.h"
+
+// A rotation followed by a translation. Being rigid, it can be carried over to the camera instead of the
+// vertices: everything a node's triangles are tested and projected against is moved into the node's own space.
+struct Transform {
+	glm::mat3 rotation{1.0f};
+	glm::vec3 translation{0.0f};
+
+	glm::vec3 apply(glm::vec3 point) const;
+	// this, then other
+	Transform then(const Transform &other) const;
+	// The same as the camera sees it from the node's own space
+	glm::vec3 toLocal(glm::vec3 worldPoint) const;
+	glm::vec4 planeToLocal(const glm::vec4 &worldPlane) const;
+	Frustum frustumToLocal(const Frustum &worldFrustum) const;
+	Projection projectionToLocal(const Projection &worldProjection) const;
+};
+
+// Nodes are stored parents first, with each node's descendants straight after it, so a culled node's whole
+// subtree can be stepped over in one go
+struct SceneNode {
+	std::string name;
+	// -1 for the root
+	int parent;
+	// one past the last of its descendants
+	size_t subtreeEnd;
+	// the mesh part it draws, or NO_PART for a node that only groups others
+	size_t part;
+	// relative to its parent
+	Transform local;
+	// worked out from local and its parents'
+	Transform world;
+	// in world space, around its own part and all its descendants'
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+	size_t subtreeTriangleCount;
+};
+
+// A mesh with its parts placed in the world by a hierarchy of nodes: a root, with a child for each part. The
+// nodes' bounds are kept up to date as transforms change, and any change gives the scene a new version(), never
+// used by any other change to any scene.
+class Scene {
+public:
+	static const size_t NO_PART = size_t(-1);
+
+	explicit Scene(Mesh sceneMesh);
+
+	const Mesh &mesh() const;
+	size_t nodeCount() const;
+	const SceneNode &node(size_t index) const;
+	// The first node by that name, or -1
+	int find(const std::string &name) const;
+	uint64_t version() const;
+
+	void setTransform(size_t index, const Transform &local);
+
+private:
+	Mesh sceneMesh;
+	std::vector<SceneNode> nodes;
+	uint64_t sceneVersion;
+
+	void update();
+};
+
+// Replaces visibleNodes with the nodes that draw a part and might be seen: a node whose bounds are wholly outside
+// the frustum is skipped along with everything under it, and its triangles are counted as outside the frustum
+// without being looked at
+CullStats cullNodes(const Scene &scene, const Frustum &frustum, std::vector<uint32_t> &visibleNodes);
@@ -0,0 +1,53 @@
+#include "ScreenshotWriter.h"
+#include <iostream>
+#include "ImageEncoding.h"
+
+ScreenshotWriter::ScreenshotWriter() : writing(false), stopping(false) {
+	thread = std::thread(&ScreenshotWriter::run, this);
+}
+
+ScreenshotWriter::~ScreenshotWriter() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+void ScreenshotWriter::capture(const FramebufferView &image, const std::string &filename) {
+	Capture capture{filename, std::vector<uint32_t>(image.width * image.height), image.width, image.height};
+	FramebufferView(capture.pixels.data(), image.width, image.height, image.width).blit(0, 0, image);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(std::move(capture));
+	}
+	wake.notify_one();
+}
+
+void ScreenshotWriter::flush() {
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+void ScreenshotWriter::run() {
+	std::vector<uint8_t> encoded;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [this] { return !queue.empty() || stopping; });
+		// anything still queued when stopping gets written first
+		if (queue.empty()) break;
+		Capture capture = std::move(queue.front());
+		queue.pop_front();
+		writing = true;
+		lock.unlock();
+
+		FramebufferView image(capture.pixels.data(), capture.width, capture.height, capture.width);
+		encodeImage(capture.filename, image, encoded);
+		if (!writeFile(capture.filename, encoded)) std::cout << "Could not write " << capture.filename << std::endl;
+
+		lock.lock();
+		writing = false;
+		finished.notify_all();
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FramebufferView.h"
+
+// Saves images on a background thread: capture only copies the pixels, and the encoding and writing happen
+// off the calling thread, so taking a screenshot doesn't hold up the next frame
+class ScreenshotWriter {
+public:
+	ScreenshotWriter();
+	// Finishes writing everything captured so far
+	~ScreenshotWriter();
+	ScreenshotWriter(const ScreenshotWriter &) = delete;
+	ScreenshotWriter &operator=(const ScreenshotWriter &) = delete;
+
+	// Snapshots image and queues it to be written to filename (as a BMP if the name ends in .bmp, otherwise
+	// as a PPM)
+	void capture(const FramebufferView &image, const std::string &filename);
+	// Blocks until everything captured so far has been written
+	void flush();
+
+private:
+	struct Capture {
+		std::string filename;
+		std::vector<uint32_t> pixels;
+		size_t width;
+		size_t height;
+	};
+
+	std::deque<Capture> queue;
+	bool writing;
+	bool stopping;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	std::thread thread;
+
+	void run();
+};
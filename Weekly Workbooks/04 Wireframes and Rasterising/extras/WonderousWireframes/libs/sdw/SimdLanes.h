@@ -0,0 +1,165 @@
+#pragma once
+
+// Thin wrappers over whichever vector instructions the compiler has been told it may use, so that
+// the rasterising and projection kernels can be written once. A "block" is LANE_COUNT horizontally adjacent
+// pixels (or consecutive vertices).
+
+#include <cstdint>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SDW_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SDW_LANES 4
+#else
+#define SDW_LANES 1
+#endif
+
+namespace lanes {
+
+const int LANE_COUNT = SDW_LANES;
+const int ALL_LANES = (1 << SDW_LANES) - 1;
+
+#if SDW_LANES == 8
+
+typedef __m256 Floats;
+typedef __m256 Mask;
+
+inline Floats broadcast(float value) { return _mm256_set1_ps(value); }
+inline Floats pixelCentres(int blockX) {
+	return _mm256_add_ps(_mm256_set1_ps(float(blockX)), _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
+}
+inline Floats laneIndices() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+inline Floats add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+inline Floats sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+inline Floats mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+inline Floats div(Floats a, Floats b) { return _mm256_div_ps(a, b); }
+inline Mask greaterEqual(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline Mask greaterThan(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline Mask lessEqual(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+inline int bits(Mask mask) { return _mm256_movemask_ps(mask); }
+inline Mask fromBits(int laneBits) {
+	return _mm256_castsi256_ps(_mm256_setr_epi32(-(laneBits & 1), -((laneBits >> 1) & 1), -((laneBits >> 2) & 1), -((laneBits >> 3) & 1),
+	                                             -((laneBits >> 4) & 1), -((laneBits >> 5) & 1), -((laneBits >> 6) & 1), -((laneBits >> 7) & 1)));
+}
+inline Floats load(const float *source) { return _mm256_loadu_ps(source); }
+inline void store(float *destination, Floats values) { _mm256_storeu_ps(destination, values); }
+// Splits LANE_COUNT consecutive (a, b, c) triples into a lane each of a, b and c
+inline void loadTriples(const float *source, Floats &a, Floats &b, Floats &c) {
+	__m256 first = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(source)), _mm_loadu_ps(source + 12), 1);
+	__m256 second = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(source + 4)), _mm_loadu_ps(source + 16), 1);
+	__m256 third = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(source + 8)), _mm_loadu_ps(source + 20), 1);
+	// each 128 bit half now holds four triples, and is split the same way as with SSE
+	__m256 ab = _mm256_shuffle_ps(second, third, _MM_SHUFFLE(2, 1, 3, 2));
+	__m256 bc = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(1, 0, 2, 1));
+	a = _mm256_shuffle_ps(first, ab, _MM_SHUFFLE(2, 0, 3, 0));
+	b = _mm256_shuffle_ps(bc, ab, _MM_SHUFFLE(3, 1, 2, 0));
+	c = _mm256_shuffle_ps(bc, third, _MM_SHUFFLE(3, 0, 3, 1));
+}
+inline Floats select(Mask mask, Floats ifSet, Floats ifClear) { return _mm256_blendv_ps(ifClear, ifSet, mask); }
+inline Floats minimum(Floats a, Floats b) { return _mm256_min_ps(a, b); }
+inline float horizontalMinimum(Floats values) {
+	__m128 half = _mm_min_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+	half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+	half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+	return _mm_cvtss_f32(half);
+}
+inline void storePixels(uint32_t *destination, Mask mask, uint32_t colour) {
+	__m256 fill = _mm256_castsi256_ps(_mm256_set1_epi32(int(colour)));
+	float *pixels = reinterpret_cast<float *>(destination);
+	if (bits(mask) == ALL_LANES) _mm256_storeu_ps(pixels, fill);
+	else _mm256_storeu_ps(pixels, _mm256_blendv_ps(_mm256_loadu_ps(pixels), fill, mask));
+}
+
+#elif SDW_LANES == 4
+
+typedef __m128 Floats;
+typedef __m128 Mask;
+
+inline Floats broadcast(float value) { return _mm_set1_ps(value); }
+inline Floats pixelCentres(int blockX) {
+	return _mm_add_ps(_mm_set1_ps(float(blockX)), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+}
+inline Floats laneIndices() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+inline Floats add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+inline Floats sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+inline Floats mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+inline Floats div(Floats a, Floats b) { return _mm_div_ps(a, b); }
+inline Mask greaterEqual(Floats a, Floats b) { return _mm_cmpge_ps(a, b); }
+inline Mask greaterThan(Floats a, Floats b) { return _mm_cmpgt_ps(a, b); }
+inline Mask lessEqual(Floats a, Floats b) { return _mm_cmple_ps(a, b); }
+inline Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+inline int bits(Mask mask) { return _mm_movemask_ps(mask); }
+inline Mask fromBits(int laneBits) {
+	return _mm_castsi128_ps(_mm_setr_epi32(-(laneBits & 1), -((laneBits >> 1) & 1), -((laneBits >> 2) & 1), -((laneBits >> 3) & 1)));
+}
+inline Floats load(const float *source) { return _mm_loadu_ps(source); }
+inline void store(float *destination, Floats values) { _mm_storeu_ps(destination, values); }
+inline void loadTriples(const float *source, Floats &a, Floats &b, Floats &c) {
+	// a0 b0 c0 a1 | b1 c1 a2 b2 | c2 a3 b3 c3
+	__m128 first = _mm_loadu_ps(source);
+	__m128 second = _mm_loadu_ps(source + 4);
+	__m128 third = _mm_loadu_ps(source + 8);
+	__m128 ab = _mm_shuffle_ps(second, third, _MM_SHUFFLE(2, 1, 3, 2));
+	__m128 bc = _mm_shuffle_ps(first, second, _MM_SHUFFLE(1, 0, 2, 1));
+	a = _mm_shuffle_ps(first, ab, _MM_SHUFFLE(2, 0, 3, 0));
+	b = _mm_shuffle_ps(bc, ab, _MM_SHUFFLE(3, 1, 2, 0));
+	c = _mm_shuffle_ps(bc, third, _MM_SHUFFLE(3, 0, 3, 1));
+}
+inline Floats select(Mask mask, Floats ifSet, Floats ifClear) {
+	return _mm_or_ps(_mm_and_ps(mask, ifSet), _mm_andnot_ps(mask, ifClear));
+}
+inline Floats minimum(Floats a, Floats b) { return _mm_min_ps(a, b); }
+inline float horizontalMinimum(Floats values) {
+	values = _mm_min_ps(values, _mm_movehl_ps(values, values));
+	values = _mm_min_ss(values, _mm_shuffle_ps(values, values, 1));
+	return _mm_cvtss_f32(values);
+}
+inline void storePixels(uint32_t *destination, Mask mask, uint32_t colour) {
+	__m128i fill = _mm_set1_epi32(int(colour));
+	__m128i *pixels = reinterpret_cast<__m128i *>(destination);
+	if (bits(mask) == ALL_LANES) {
+		_mm_storeu_si128(pixels, fill);
+	} else {
+		__m128i select = _mm_castps_si128(mask);
+		_mm_storeu_si128(pixels, _mm_or_si128(_mm_and_si128(select, fill), _mm_andnot_si128(select, _mm_loadu_si128(pixels))));
+	}
+}
+
+#else
+
+typedef float Floats;
+typedef bool Mask;
+
+inline Floats broadcast(float value) { return value; }
+inline Floats pixelCentres(int blockX) { return float(blockX) + 0.5f; }
+inline Floats laneIndices() { return 0.0f; }
+inline Floats add(Floats a, Floats b) { return a + b; }
+inline Floats sub(Floats a, Floats b) { return a - b; }
+inline Floats mul(Floats a, Floats b) { return a * b; }
+inline Floats div(Floats a, Floats b) { return a / b; }
+inline Mask greaterEqual(Floats a, Floats b) { return a >= b; }
+inline Mask greaterThan(Floats a, Floats b) { return a > b; }
+inline Mask lessEqual(Floats a, Floats b) { return a <= b; }
+inline Mask both(Mask a, Mask b) { return a && b; }
+inline int bits(Mask mask) { return mask ? 1 : 0; }
+inline Mask fromBits(int laneBits) { return (laneBits & 1) != 0; }
+inline Floats load(const float *source) { return *source; }
+inline void store(float *destination, Floats values) { *destination = values; }
+inline void loadTriples(const float *source, Floats &a, Floats &b, Floats &c) {
+	a = source[0];
+	b = source[1];
+	c = source[2];
+}
+inline Floats select(Mask mask, Floats ifSet, Floats ifClear) { return mask ? ifSet : ifClear; }
+inline Floats minimum(Floats a, Floats b) { return a < b ? a : b; }
+inline float horizontalMinimum(Floats values) { return values; }
+inline void storePixels(uint32_t *destination, Mask mask, uint32_t colour) {
+	if (mask) *destination = colour;
+}
+
+#endif
+
+}
@@ -0,0 +1,82 @@
+#include "TextureCache.h"
+
+TextureCache::TextureCache(size_t budget) : budgetBytes(budget), bytes(0) {}
+
+TextureCache &TextureCache::shared() {
+	static TextureCache cache;
+	return cache;
+}
+
+std::shared_ptr<const TextureMap> TextureCache::get(const std::string &filename) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto found = entries.find(filename);
+	if (found != entries.end()) {
+		Entry &entry = found->second;
+		if (entry.resident) {
+			recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, entry.use);
+			return entry.resident;
+		}
+		std::shared_ptr<const TextureMap> texture = entry.texture.lock();
+		if (texture) {
+			makeResident(filename, entry, texture);
+			evictBeyondBudget();
+			return texture;
+		}
+	}
+	// loaded under the lock, so two threads asking for the same file can't both load it
+	std::shared_ptr<const TextureMap> texture = std::make_shared<const TextureMap>(filename, TextureLayout::TILED);
+	makeResident(filename, entries[filename], texture);
+	evictBeyondBudget();
+	return texture;
+}
+
+size_t TextureCache::residentBytes() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return bytes;
+}
+
+size_t TextureCache::residentCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return recentlyUsed.size();
+}
+
+size_t TextureCache::budget() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return budgetBytes;
+}
+
+void TextureCache::setBudget(size_t budget) {
+	std::lock_guard<std::mutex> lock(mutex);
+	budgetBytes = budget;
+	evictBeyondBudget();
+}
+
+void TextureCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+	recentlyUsed.clear();
+	bytes = 0;
+}
+
+void TextureCache::makeResident(const std::string &filename, Entry &entry, std::shared_ptr<const TextureMap> texture) {
+	recentlyUsed.push_front(filename);
+	entry.use = recentlyUsed.begin();
+	entry.texture = texture;
+	bytes += texture->sizeInBytes();
+	entry.resident = std::move(texture);
+}
+
+void TextureCache::evictBeyondBudget() {
+	// the most recently used texture always stays, even when it's over the budget on its own
+	while (bytes > budgetBytes && recentlyUsed.size() > 1) {
+		auto evicted = entries.find(recentlyUsed.back());
+		bytes -= evicted->second.resident->sizeInBytes();
+		recentlyUsed.pop_back();
+		if (evicted->second.resident.use_count() == 1) {
+			// nobody else has it, so there's nothing to find again
+			entries.erase(evicted);
+		} else {
+			evicted->second.resident.reset();
+		}
+	}
+}
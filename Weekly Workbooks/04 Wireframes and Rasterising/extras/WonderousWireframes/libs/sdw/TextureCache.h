@@ -0,0 +1,54 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "TextureMap.h"
+
+// Loads each texture file once and hands out shared, read only handles to it. The cache keeps the most
+// recently used textures resident up to a budget in bytes, dropping its own reference to the least recently
+// used ones beyond that; a dropped texture lives on for as long as anyone else holds a handle, and asking
+// for it again in the meantime gives back that same copy rather than loading another. Cached textures are only
+// ever read through a TextureSampler, so they're stored TILED.
+class TextureCache {
+public:
+	static const size_t DEFAULT_BUDGET = size_t(256) << 20;
+
+	explicit TextureCache(size_t budgetBytes = DEFAULT_BUDGET);
+	TextureCache(const TextureCache &) = delete;
+	TextureCache &operator=(const TextureCache &) = delete;
+
+	// The one the whole program shares
+	static TextureCache &shared();
+
+	// Throws std::invalid_argument if the file can't be loaded
+	std::shared_ptr<const TextureMap> get(const std::string &filename);
+	// Bytes of pixels the cache is keeping resident
+	size_t residentBytes() const;
+	size_t residentCount() const;
+	size_t budget() const;
+	// Evicts straight away if the resident textures no longer fit
+	void setBudget(size_t budgetBytes);
+	void clear();
+
+private:
+	struct Entry {
+		// null once evicted, when only the weak reference remains
+		std::shared_ptr<const TextureMap> resident;
+		std::weak_ptr<const TextureMap> texture;
+		// where it sits in recentlyUsed, while resident
+		std::list<std::string>::iterator use;
+	};
+
+	std::unordered_map<std::string, Entry> entries;
+	// most recently used at the front
+	std::list<std::string> recentlyUsed;
+	size_t budgetBytes;
+	size_t bytes;
+	mutable std::mutex mutex;
+
+	void makeResident(const std::string &filename, Entry &entry, std::shared_ptr<const TextureMap> texture);
+	void evictBeyondBudget();
+};
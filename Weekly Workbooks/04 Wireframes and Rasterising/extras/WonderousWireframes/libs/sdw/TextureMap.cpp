@@ -1,34 +1,226 @@
 #include "TextureMap.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <filesystem>
+#include "ImageEncoding.h"
+#include "MappedFile.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Walks the header fields, which may be separated by any whitespace, with # comments (running to the end of the
+// line) allowed wherever whitespace is
+struct PpmReader {
+	const uint8_t *position;
+	const uint8_t *end;
+	const std::string &filename;
+
+	void skipSeparators() {
+		while (position != end) {
+			if (*position == '#') {
+				while (position != end && *position != '\n' && *position != '\r') position++;
+			} else if (std::isspace(*position)) {
+				position++;
+			} else {
+				break;
+			}
+		}
+	}
+
+	size_t readNumber(const char *field) {
+		skipSeparators();
+		if (position == end || !std::isdigit(*position)) {
+			throw std::invalid_argument("Failed to parse the " + std::string(field) + " of " + filename);
+		}
+		size_t value = 0;
+		while (position != end && std::isdigit(*position)) {
+			value = value * 10 + size_t(*position - '0');
+			if (value > 1 << 30) throw std::invalid_argument("The " + std::string(field) + " of " + filename + " is too large");
+			position++;
+		}
+		return value;
+	}
+};
+
+// Every sample value up to maxValue, scaled (and rounded) to 0 to 255
+std::vector<uint8_t> scaleTable(size_t maxValue) {
+	std::vector<uint8_t> table(maxValue + 1);
+	for (size_t value = 0; value <= maxValue; value++) table[value] = uint8_t((value * 255 + maxValue / 2) / maxValue);
+	return table;
+}
+
+size_t halved(size_t size) {
+	return std::max<size_t>(size / 2, 1);
+}
+
+// Averages each 2x2 block of source into one pixel of destination (which is halved(width) x halved(height)),
+// every channel rounded to nearest. An odd last row or column is averaged with itself.
+void downsample(const uint32_t *source, size_t width, size_t height, uint32_t *destination) {
+	size_t outWidth = halved(width);
+	size_t outHeight = halved(height);
+	for (size_t y = 0; y < outHeight; y++) {
+		const uint32_t *top = source + std::min(y * 2, height - 1) * width;
+		const uint32_t *bottom = source + std::min(y * 2 + 1, height - 1) * width;
+		uint32_t *out = destination + y * outWidth;
+		size_t x = 0;
+#if defined(__SSE2__)
+		// 4 source pixels from each row make 2 destination pixels, with the channels widened to 16 bits to sum
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i half = _mm_set1_epi16(2);
+		for (; x * 2 + 4 <= width; x += 2) {
+			__m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + x * 2));
+			__m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + x * 2));
+			__m128i left = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+			__m128i right = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+			__m128i sums = _mm_unpacklo_epi64(_mm_add_epi16(left, _mm_srli_si128(left, 8)), _mm_add_epi16(right, _mm_srli_si128(right, 8)));
+			sums = _mm_srli_epi16(_mm_add_epi16(sums, half), 2);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(out + x), _mm_packus_epi16(sums, sums));
+		}
+#endif
+		for (; x < outWidth; x++) {
+			size_t left = std::min(x * 2, width - 1);
+			size_t right = std::min(x * 2 + 1, width - 1);
+			uint32_t corners[4] = {top[left], top[right], bottom[left], bottom[right]};
+			uint32_t pixel = 0;
+			for (int shift = 0; shift < 32; shift += 8) {
+				uint32_t sum = 2;
+				for (uint32_t corner : corners) sum += (corner >> shift) & 0xFF;
+				pixel |= (sum >> 2) << shift;
+			}
+			out[x] = pixel;
+		}
+	}
+}
+
+size_t tilesFor(size_t size) {
+	return (size + TextureMap::TILE_SIZE - 1) / TextureMap::TILE_SIZE;
+}
+
+// Copies one row of texels within each tile at a time. Padding texels (which sampling never reads) are zero.
+std::vector<uint32_t> relaid(const std::vector<uint32_t> &source, size_t width, size_t height, TextureLayout to) {
+	const size_t tileSize = TextureMap::TILE_SIZE;
+	size_t tilesAcross = tilesFor(width);
+	std::vector<uint32_t> result(to == TextureLayout::TILED ? tilesAcross * tilesFor(height) * tileSize * tileSize : width * height);
+	for (size_t y = 0; y < height; y++) {
+		for (size_t tileX = 0; tileX < tilesAcross; tileX++) {
+			size_t linear = y * width + tileX * tileSize;
+			size_t tiled = ((y / tileSize) * tilesAcross + tileX) * tileSize * tileSize + (y % tileSize) * tileSize;
+			size_t count = std::min(tileSize, width - tileX * tileSize) * sizeof(uint32_t);
+			if (to == TextureLayout::TILED) std::memcpy(&result[tiled], &source[linear], count);
+			else std::memcpy(&result[linear], &source[tiled], count);
+		}
+	}
+	return result;
+}
+
+}
 
 TextureMap::TextureMap() = default;
-TextureMap::TextureMap(const std::string &filename) {
-	std::ifstream inputStream(filename, std::ifstream::binary);
-	if(! inputStream) std::cout << "The file " << filename << " cannot be accessed by the TextureMap class...\nThis is usually because the PPM file is in the wrong folder\nOr you are passing in the wrong relative path" << std::endl;
-	std::string nextLine;
-	// Get the "P6" magic number
-	std::getline(inputStream, nextLine);
-	// Read the width and height line
-	std::getline(inputStream, nextLine);
-	// Skip over any comment lines !
-	while (nextLine.at(0) == '#') std::getline(inputStream, nextLine);
-	auto widthAndHeight = split(nextLine, ' ');
-	if (widthAndHeight.size() != 2)
-		throw std::invalid_argument("Failed to parse width and height line, line was `" + nextLine + "`");
-
-	width = std::stoi(widthAndHeight[0]);
-	height = std::stoi(widthAndHeight[1]);
-	// Read the max value (which we assume is 255)
-	std::getline(inputStream, nextLine);
-
-	pixels.resize(width * height);
-	for (size_t i = 0; i < width * height; i++) {
-		int red = inputStream.get();
-		int green = inputStream.get();
-		int blue = inputStream.get();
-		pixels[i] = ((255 << 24) + (red << 16) + (green << 8) + (blue));
-	}
-	inputStream.close();
+TextureMap::TextureMap(const std::string &filename, TextureLayout textureLayout) {
+	MappedFile file(filename);
+	if (!file.isOpen()) {
+		std::cout << "The file " << filename << " cannot be accessed by the TextureMap class...\nThis is usually because the PPM file is in the wrong folder\nOr you are passing in the wrong relative path" << std::endl;
+		throw std::invalid_argument("Could not open " + filename);
+	}
+	PpmReader reader{file.data(), file.data() + file.size(), filename};
+	// P6 is binary, P3 the same fields written out as decimal text
+	if (file.size() < 2 || file.data()[0] != 'P' || (file.data()[1] != '6' && file.data()[1] != '3')) {
+		throw std::invalid_argument(filename + " is not a P3 or P6 PPM file");
+	}
+	bool binary = file.data()[1] == '6';
+	reader.position += 2;
+	width = reader.readNumber("width");
+	height = reader.readNumber("height");
+	// there would be no texel to clamp sampling to
+	if (width == 0 || height == 0) throw std::invalid_argument(filename + " has no pixels");
+	size_t maxValue = reader.readNumber("maximum value");
+	if (maxValue == 0 || maxValue > 65535) throw std::invalid_argument("The maximum value of " + filename + " is out of range");
+
+	size_t count = width * height;
+	if (!binary) {
+		// every sample takes at least a digit and a separator
+		if (size_t(reader.end - reader.position) < count * 3 * 2) throw std::invalid_argument(filename + " is truncated");
+		pixels.resize(count);
+		std::vector<uint8_t> scale = scaleTable(maxValue);
+		for (size_t i = 0; i < count; i++) {
+			uint32_t channels[3];
+			for (uint32_t &channel : channels) channel = scale[std::min(reader.readNumber("pixels"), maxValue)];
+			pixels[i] = (0xFFu << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+		}
+		generateMipmaps();
+		setLayout(textureLayout);
+		return;
+	}
+
+	// A single whitespace character separates the header from the samples, which could themselves be whitespace
+	if (reader.position == reader.end || !std::isspace(*reader.position)) {
+		throw std::invalid_argument("Failed to parse the header of " + filename);
+	}
+	reader.position++;
+	// 16 bit samples are big endian
+	size_t sampleSize = maxValue > 255 ? 2 : 1;
+	if (size_t(reader.end - reader.position) < count * 3 * sampleSize) throw std::invalid_argument(filename + " is truncated");
+	const uint8_t *samples = reader.position;
+	pixels.resize(count);
+	if (maxValue == 255) {
+		unpackPixels(samples, count, pixels.data());
+	} else {
+		std::vector<uint8_t> scale = scaleTable(maxValue);
+		for (size_t i = 0; i < count; i++) {
+			uint32_t channels[3];
+			for (int c = 0; c < 3; c++) {
+				const uint8_t *sample = samples + (i * 3 + c) * sampleSize;
+				size_t value = sampleSize == 2 ? (size_t(sample[0]) << 8) | sample[1] : sample[0];
+				channels[c] = scale[std::min(value, maxValue)];
+			}
+			pixels[i] = (0xFFu << 24) | (channels[0] << 16) | (channels[1] << 8) | channels[2];
+		}
+	}
+	generateMipmaps();
+	setLayout(textureLayout);
+}
+
+void TextureMap::generateMipmaps() {
+	// the box filter works on rows
+	TextureLayout original = layout;
+	mipmaps.clear();
+	setLayout(TextureLayout::LINEAR);
+	if (pixels.empty()) return;
+	TextureLevel previous = level(0);
+	while (previous.width > 1 || previous.height > 1) {
+		mipmaps.emplace_back(halved(previous.width) * halved(previous.height));
+		downsample(previous.pixels, previous.width, previous.height, mipmaps.back().data());
+		previous = level(mipmaps.size());
+	}
+	setLayout(original);
+}
+
+void TextureMap::setLayout(TextureLayout newLayout) {
+	if (newLayout == layout) return;
+	pixels = relaid(pixels, width, height, newLayout);
+	for (size_t index = 1; index < levelCount(); index++) {
+		TextureLevel mipLevel = level(index);
+		mipmaps[index - 1] = relaid(mipmaps[index - 1], mipLevel.width, mipLevel.height, newLayout);
+	}
+	layout = newLayout;
+}
+
+size_t TextureMap::levelCount() const {
+	return 1 + mipmaps.size();
+}
+
+TextureLevel TextureMap::level(size_t index) const {
+	if (index == 0) return TextureLevel{pixels.data(), width, height};
+	return TextureLevel{mipmaps[index - 1].data(), std::max<size_t>(width >> index, 1), std::max<size_t>(height >> index, 1)};
+}
+
+size_t TextureMap::sizeInBytes() const {
+	size_t count = pixels.size();
+	for (const std::vector<uint32_t> &mipmap : mipmaps) count += mipmap.size();
+	return count * sizeof(uint32_t);
 }
 
 std::ostream &operator<<(std::ostream &os, const TextureMap &map) {
@@ -6,13 +6,45 @@
 #include "Utils.h"
 #include <cstdint>
 
+enum class TextureLayout {
+	// row after row
+	LINEAR,
+	// TILE_SIZE x TILE_SIZE tiles (64 bytes, a cache line, each) in rows of tiles, with each tile's texels row
+	// by row. Whichever way a span runs across the texture, its next texel is then usually in the same line.
+	// Rows and columns are padded out to whole tiles.
+	TILED
+};
+
+// One level of a texture's mip pyramid, laid out as the texture says
+struct TextureLevel {
+	const uint32_t *pixels;
+	size_t width;
+	size_t height;
+};
+
 class TextureMap {
 public:
+	static const int TILE_SIZE = 4;
+
 	size_t width;
 	size_t height;
 	std::vector<uint32_t> pixels;
+	// of pixels and every mip level
+	TextureLayout layout{TextureLayout::LINEAR};
+	// Levels 1 onwards, each a 2x2 box filtered half of the one before (rounding down, but never below 1), down
+	// to 1x1. Empty until generateMipmaps, which loading from a file calls.
+	std::vector<std::vector<uint32_t>> mipmaps;
 
 	TextureMap();
-	TextureMap(const std::string &filename);
+	explicit TextureMap(const std::string &filename, TextureLayout textureLayout = TextureLayout::LINEAR);
+	// Rebuilds mipmaps from pixels
+	void generateMipmaps();
+	// Rearranges pixels and every mip level
+	void setLayout(TextureLayout newLayout);
+	size_t levelCount() const;
+	// Level 0 is pixels itself
+	TextureLevel level(size_t index) const;
+	// Of pixels and every mip level
+	size_t sizeInBytes() const;
 	friend std::ostream &operator<<(std::ostream &os, const TextureMap &point);
 };
@@ -0,0 +1,139 @@
+#include "TextureSampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// A mip level, with its clamping limits worked out up front
+struct Level {
+	const uint32_t *pixels;
+	size_t width;
+	int32_t maxX;
+	int32_t maxY;
+	// only for TextureLayout::TILED
+	size_t tilesAcross;
+};
+
+Level levelOf(const TextureMap &texture, int index) {
+	TextureLevel level = texture.level(size_t(index));
+	size_t tilesAcross = (level.width + TextureMap::TILE_SIZE - 1) / TextureMap::TILE_SIZE;
+	return Level{level.pixels, level.width, int32_t(level.width) - 1, int32_t(level.height) - 1, tilesAcross};
+}
+
+template <TextureLayout layout>
+inline uint32_t texel(const Level &level, int32_t x, int32_t y) {
+	x = std::min(std::max(x, 0), level.maxX);
+	y = std::min(std::max(y, 0), level.maxY);
+	if (layout == TextureLayout::LINEAR) return level.pixels[size_t(y) * level.width + size_t(x)];
+	// clamped, so unsigned, which lets the divisions be plain shifts
+	const size_t tileSize = TextureMap::TILE_SIZE;
+	size_t column = size_t(x), row = size_t(y);
+	size_t tile = (row / tileSize) * level.tilesAcross + column / tileSize;
+	return level.pixels[tile * tileSize * tileSize + (row % tileSize) * tileSize + column % tileSize];
+}
+
+// weight out of 256. Blends two channels at once: 0x00FF00FF picks out blue and red, 0xFF00FF00 (shifted down)
+// green and alpha.
+uint32_t blend(uint32_t a, uint32_t b, uint32_t weight) {
+	uint32_t lowA = a & 0x00FF00FF, highA = (a >> 8) & 0x00FF00FF;
+	uint32_t lowB = b & 0x00FF00FF, highB = (b >> 8) & 0x00FF00FF;
+	uint32_t low = ((lowA * (256 - weight) + lowB * weight) >> 8) & 0x00FF00FF;
+	uint32_t high = (highA * (256 - weight) + highB * weight) & 0xFF00FF00;
+	return low | high;
+}
+
+// (u, v) are in the level's own texels
+template <TextureLayout layout>
+uint32_t sampleNearest(const Level &level, int32_t u, int32_t v) {
+	return texel<layout>(level, u >> TextureSampler::FRACTION_BITS, v >> TextureSampler::FRACTION_BITS);
+}
+
+template <TextureLayout layout>
+uint32_t sampleBilinear(const Level &level, int32_t u, int32_t v) {
+	// texel centres sit at +0.5, so shift back by half a texel to find the four that surround (u, v)
+	u -= TextureSampler::ONE / 2;
+	v -= TextureSampler::ONE / 2;
+	int32_t x = u >> TextureSampler::FRACTION_BITS;
+	int32_t y = v >> TextureSampler::FRACTION_BITS;
+	uint32_t fx = uint32_t(u >> (TextureSampler::FRACTION_BITS - 8)) & 0xFF;
+	uint32_t fy = uint32_t(v >> (TextureSampler::FRACTION_BITS - 8)) & 0xFF;
+	uint32_t top = blend(texel<layout>(level, x, y), texel<layout>(level, x + 1, y), fx);
+	uint32_t bottom = blend(texel<layout>(level, x, y + 1), texel<layout>(level, x + 1, y + 1), fx);
+	return blend(top, bottom, fy);
+}
+
+// Takes level 0 texture coordinates and steps down to the given level's. Shifting the steps too loses their
+// lowest bits, but that's under 1/65536 of a texel per pixel at the level being sampled.
+void toLevel(int index, int32_t &u, int32_t &v, int32_t &du, int32_t &dv) {
+	u >>= index;
+	v >>= index;
+	du >>= index;
+	dv >>= index;
+}
+
+template <TextureLayout layout>
+void sampleSpanFrom(const TextureMap &texture, TextureFilter filter, uint32_t *destination, int count,
+                    int32_t u, int32_t v, int32_t du, int32_t dv, float footprint) {
+	// how many halvings of level 0 match the footprint
+	float detail = footprint > 1.0f ? std::log2(footprint) : 0.0f;
+	int lastLevel = int(texture.levelCount()) - 1;
+	if (filter == TextureFilter::TRILINEAR) {
+		int fine = std::min(int(detail), lastLevel);
+		uint32_t weight = fine < lastLevel ? uint32_t((detail - float(fine)) * 256.0f) : 0;
+		Level fineLevel = levelOf(texture, fine);
+		toLevel(fine, u, v, du, dv);
+		if (weight == 0) {
+			for (int i = 0; i < count; i++, u += du, v += dv) destination[i] = sampleBilinear<layout>(fineLevel, u, v);
+			return;
+		}
+		Level coarseLevel = levelOf(texture, fine + 1);
+		for (int i = 0; i < count; i++, u += du, v += dv) {
+			uint32_t fineTexel = sampleBilinear<layout>(fineLevel, u, v);
+			uint32_t coarseTexel = sampleBilinear<layout>(coarseLevel, u >> 1, v >> 1);
+			destination[i] = blend(fineTexel, coarseTexel, weight);
+		}
+		return;
+	}
+	int nearest = std::min(int(detail + 0.5f), lastLevel);
+	Level level = levelOf(texture, nearest);
+	toLevel(nearest, u, v, du, dv);
+	// keep the filter check out of the per-pixel loop
+	if (filter == TextureFilter::BILINEAR) {
+		for (int i = 0; i < count; i++, u += du, v += dv) destination[i] = sampleBilinear<layout>(level, u, v);
+	} else {
+		for (int i = 0; i < count; i++, u += du, v += dv) destination[i] = sampleNearest<layout>(level, u, v);
+	}
+}
+
+}
+
+TextureSampler::TextureSampler(const TextureMap &map, TextureFilter textureFilter, bool perspective) :
+		texture(map),
+		filter(textureFilter),
+		perspectiveCorrect(perspective) {}
+
+uint32_t TextureSampler::sample(int32_t u, int32_t v) const {
+	Level level = levelOf(texture, 0);
+	if (texture.layout == TextureLayout::TILED) {
+		if (filter == TextureFilter::NEAREST) return sampleNearest<TextureLayout::TILED>(level, u, v);
+		return sampleBilinear<TextureLayout::TILED>(level, u, v);
+	}
+	if (filter == TextureFilter::NEAREST) return sampleNearest<TextureLayout::LINEAR>(level, u, v);
+	return sampleBilinear<TextureLayout::LINEAR>(level, u, v);
+}
+
+bool TextureSampler::mipmapped() const {
+	return texture.levelCount() > 1;
+}
+
+void TextureSampler::sampleSpan(uint32_t *destination, int count, int32_t u, int32_t v, int32_t du, int32_t dv, float footprint) const {
+	if (texture.layout == TextureLayout::TILED) {
+		sampleSpanFrom<TextureLayout::TILED>(texture, filter, destination, count, u, v, du, dv, footprint);
+	} else {
+		sampleSpanFrom<TextureLayout::LINEAR>(texture, filter, destination, count, u, v, du, dv, footprint);
+	}
+}
+
+int32_t toFixedPoint(float value) {
+	return int32_t(std::lround(value * float(TextureSampler::ONE)));
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "TextureMap.h"
+
+enum class TextureFilter {
+	NEAREST,
+	BILINEAR,
+	// bilinear in the two mip levels either side of the footprint, blended by how far it is between them
+	TRILINEAR
+};
+
+// Reads texels straight out of a TextureMap's pixels (which it refers to, never copies). Texture
+// coordinates are in level 0 texels and 16.16 fixed point, and fall back to the nearest edge texel when
+// outside. Spans read from the mip level matching their footprint (the nearest one, or the two either side
+// for TRILINEAR), so a distant surface touches about as many texels as a near one.
+class TextureSampler {
+public:
+	static const int FRACTION_BITS = 16;
+	static const int32_t ONE = 1 << FRACTION_BITS;
+
+	const TextureMap &texture;
+	TextureFilter filter;
+	// Interpolate u/z and v/z rather than u and v, so textures don't swim on triangles seen at an angle
+	bool perspectiveCorrect;
+
+	explicit TextureSampler(const TextureMap &map, TextureFilter textureFilter = TextureFilter::NEAREST, bool perspective = false);
+	// From level 0
+	uint32_t sample(int32_t u, int32_t v) const;
+	// Whether there's more than one level, so that footprints matter
+	bool mipmapped() const;
+	// Fills count pixels, stepping (u, v) by (du, dv) after each one. footprint is how many level 0 texels a
+	// pixel spans (the longer of the texture coordinates' derivatives across and down the screen).
+	void sampleSpan(uint32_t *destination, int count, int32_t u, int32_t v, int32_t du, int32_t dv, float footprint = 1.0f) const;
+};
+
+int32_t toFixedPoint(float value);
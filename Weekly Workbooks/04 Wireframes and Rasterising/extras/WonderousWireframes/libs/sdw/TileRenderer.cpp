@@ -0,0 +1,134 @@
+#include "TileRenderer.h"
+#include <algorithm>
+#include "Clipper.h"
+#include "TextureSampler.h"
+
+// a render tile must never split a Hi-Z tile, or two threads could both update its coarse depth
+static_assert(TileRenderer::TILE_SIZE % DepthBuffer::TILE_SIZE == 0, "render tiles must hold whole depth tiles");
+
+TileRenderer::TileRenderer(size_t threadCount) {
+	if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+	// the thread calling render() does its share of the tiles too
+	for (size_t i = 1; i < threadCount; i++) workers.emplace_back(&TileRenderer::workerLoop, this);
+}
+
+TileRenderer::~TileRenderer() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread &worker : workers) worker.join();
+}
+
+size_t TileRenderer::threadCount() const {
+	return workers.size() + 1;
+}
+
+void TileRenderer::submit(const CanvasTriangle &triangle, uint32_t colour) {
+	commands.push_back({triangle, colour, nullptr});
+}
+
+void TileRenderer::submit(const CanvasTriangle &triangle, const TextureMap &texture) {
+	commands.push_back({triangle, 0, &texture});
+}
+
+void TileRenderer::render(const FramebufferView &view) {
+	dispatch(view, nullptr);
+}
+
+void TileRenderer::render(const FramebufferView &view, DepthBuffer &depthBuffer) {
+	dispatch(view, &depthBuffer);
+}
+
+void TileRenderer::dispatch(const FramebufferView &view, DepthBuffer *depthBuffer) {
+	binCommands(view.width, view.height);
+	target = view;
+	targetDepth = depthBuffer;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		nextTile = 0;
+		busyWorkers = workers.size();
+		generation++;
+	}
+	wake.notify_all();
+	rasteriseTiles();
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] { return busyWorkers == 0; });
+	}
+	commands.clear();
+}
+
+void TileRenderer::binCommands(size_t width, size_t height) {
+	tilesAcross = int((width + TILE_SIZE - 1) / TILE_SIZE);
+	tilesDown = int((height + TILE_SIZE - 1) / TILE_SIZE);
+	// keep each bin's capacity from frame to frame, so binning doesn't allocate once warmed up
+	bins.resize(tilesAcross * tilesDown);
+	for (std::vector<uint32_t> &bin : bins) bin.clear();
+	setUpCommands.clear();
+
+	// each triangle is set up here, once, however many tiles it covers; every tile then only narrows its bounds
+	ClipRect wholeTarget{0, 0, int(width) - 1, int(height) - 1};
+	CanvasTriangle pieces[MAX_GUARD_BAND_CLIPPED_TRIANGLES];
+	for (const Command &command : commands) {
+		int count = clipToGuardBand(command.triangle, float(width), float(height), pieces);
+		for (int i = 0; i < count; i++) {
+			SetUpCommand setUp;
+			// rejects triangles with no pixels on the target, or NaN coordinates
+			if (!setUpTriangle(pieces[i], wholeTarget, setUp.setup)) continue;
+			setUp.colour = command.colour;
+			setUp.texture = command.texture;
+			uint32_t index = uint32_t(setUpCommands.size());
+			setUpCommands.push_back(setUp);
+			for (int row = setUp.setup.minY / TILE_SIZE; row <= setUp.setup.maxY / TILE_SIZE; row++) {
+				for (int column = setUp.setup.minX / TILE_SIZE; column <= setUp.setup.maxX / TILE_SIZE; column++) {
+					bins[row * tilesAcross + column].push_back(index);
+				}
+			}
+		}
+	}
+}
+
+void TileRenderer::rasteriseTiles() {
+	int tileCount = tilesAcross * tilesDown;
+	int width = int(target.width);
+	int height = int(target.height);
+	for (int tile = nextTile++; tile < tileCount; tile = nextTile++) {
+		const std::vector<uint32_t> &bin = bins[tile];
+		if (bin.empty()) continue;
+		int column = tile % tilesAcross;
+		int row = tile / tilesAcross;
+		ClipRect clip{};
+		clip.minX = column * TILE_SIZE;
+		clip.minY = row * TILE_SIZE;
+		clip.maxX = std::min(clip.minX + TILE_SIZE, width) - 1;
+		clip.maxY = std::min(clip.minY + TILE_SIZE, height) - 1;
+		for (uint32_t index : bin) {
+			const SetUpCommand &command = setUpCommands[index];
+			if (command.texture) {
+				TextureSampler sampler(*command.texture, TextureFilter::TRILINEAR, true);
+				if (targetDepth) fillTexturedTriangle(target, *targetDepth, command.setup, sampler, clip);
+				else fillTexturedTriangle(target, command.setup, sampler, clip);
+			} else if (targetDepth) {
+				fillTriangle(target, *targetDepth, command.setup, command.colour, clip);
+			} else {
+				fillTriangle(target, command.setup, command.colour, clip);
+			}
+		}
+	}
+}
+
+void TileRenderer::workerLoop() {
+	size_t seenGeneration = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+		if (stopping) return;
+		seenGeneration = generation;
+		lock.unlock();
+		rasteriseTiles();
+		lock.lock();
+		if (--busyWorkers == 0) finished.notify_one();
+	}
+}
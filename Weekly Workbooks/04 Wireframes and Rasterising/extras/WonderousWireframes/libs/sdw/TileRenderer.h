@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CanvasTriangle.h"
+#include "DepthBuffer.h"
+#include "FramebufferView.h"
+#include "Rasteriser.h"
+#include "TextureMap.h"
+
+// Sort-middle renderer: submitted triangles are clipped to the guard band, set up once and binned into fixed
+// size screen tiles, then a pool of worker threads rasterises whole tiles in parallel. Each tile is owned by exactly one thread at a time
+// and draws its triangles in submission order, so the result matches drawing them one after another.
+class TileRenderer {
+public:
+	static const int TILE_SIZE = 32;
+
+	// threadCount includes the calling thread (0 picks one per hardware thread)
+	explicit TileRenderer(size_t threadCount = 0);
+	~TileRenderer();
+	TileRenderer(const TileRenderer &) = delete;
+	TileRenderer &operator=(const TileRenderer &) = delete;
+
+	void submit(const CanvasTriangle &triangle, uint32_t colour);
+	// Textured instead, with each vertex's texturePoint in texels. The texture is sampled trilinearly and with
+	// perspective, and must outlive the next render.
+	void submit(const CanvasTriangle &triangle, const TextureMap &texture);
+	// Rasterises everything submitted since the last call, then empties the queue
+	void render(const FramebufferView &target);
+	// As above, depth testing every triangle against depthBuffer (which must match the target's size)
+	void render(const FramebufferView &target, DepthBuffer &depthBuffer);
+	size_t threadCount() const;
+
+private:
+	// texture is null for a flat coloured triangle
+	struct Command {
+		CanvasTriangle triangle;
+		uint32_t colour;
+		const TextureMap *texture;
+	};
+
+	struct SetUpCommand {
+		TriangleSetup setup;
+		uint32_t colour;
+		const TextureMap *texture;
+	};
+
+	std::vector<Command> commands;
+	// what binning turns commands into, which the bins index
+	std::vector<SetUpCommand> setUpCommands;
+	std::vector<std::vector<uint32_t>> bins;
+	int tilesAcross = 0;
+	int tilesDown = 0;
+	FramebufferView target;
+	DepthBuffer *targetDepth = nullptr;
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	size_t generation = 0;
+	size_t busyWorkers = 0;
+	bool stopping = false;
+	std::atomic<int> nextTile{0};
+
+	void dispatch(const FramebufferView &view, DepthBuffer *depthBuffer);
+	void binCommands(size_t width, size_t height);
+	void rasteriseTiles();
+	void workerLoop();
+};
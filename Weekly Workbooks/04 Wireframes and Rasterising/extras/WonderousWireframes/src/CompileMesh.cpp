@@ -0,0 +1,31 @@
+#include <Mesh.h>
+#include <MeshFile.h>
+#include <ObjLoader.h>
+#include <iostream>
+#include <stdexcept>
+
+// Compiles an OBJ and its MTL into the binary mesh that WonderousWireframes maps instead of parsing them:
+//   CompileMesh models/cornell-box.obj models/cornell-box.mtl [models/cornell-box.mesh]
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <model.obj> <materials.mtl> [output.mesh]" << std::endl;
+		return 1;
+	}
+	std::string objFilename = argv[1];
+	std::string mtlFilename = argv[2];
+	std::string meshFilename = argc > 3 ? argv[3] : meshFilenameFor(objFilename);
+	try {
+		// the vertices are merged here, once, so loading the file never has to
+		Mesh mesh = buildMesh(loadObj(objFilename, mtlFilename).view());
+		if (!writeMeshFile(meshFilename, mesh, objFilename, mtlFilename)) {
+			std::cout << "Could not write " << meshFilename << std::endl;
+			return 1;
+		}
+		std::cout << "Wrote " << mesh.triangleCount() << " triangles (" << mesh.positions.size() << " vertices) in " << mesh.parts.size() << " parts to "
+		          << meshFilename << std::endl;
+	} catch (const std::invalid_argument &error) {
+		std::cout << error.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -1,9 +1,29 @@
 #include <CanvasTriangle.h>
 #include <CanvasPoint.h>
+#include <Camera.h>
+#include <Clipper.h>
 #include <Colour.h>
+#include <Culling.h>
+#include <DepthBuffer.h>
+#ifndef SDW_HEADLESS
 #include <DrawingWindow.h>
+#endif
+#include <Framebuffer.h>
+#include <FrameSink.h>
+#include <LineRasteriser.h>
+#include <Mesh.h>
+#include <MeshFile.h>
+#include <ObjLoader.h>
+#include <Projection.h>
 #include <Utils.h>
-#include <fstream>
+#include <Rasteriser.h>
+#include <Scene.h>
+#include <ScreenshotWriter.h>
+#include <TextureCache.h>
+#include <TileRenderer.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <vector>
 
 #include "ModelTriangle.h"
@@ -15,6 +35,13 @@
 #define STROKED 0
 #define FILLED 1
 
+#define IMAGE_PLANE_SCALE 160
+#define NEAR_PLANE_DISTANCE 0.1f
+// how far the arrow keys swing the camera round the scene (in radians) and move it forward and back
+#define ORBIT_STEP 0.05f
+#define MOVE_STEP 0.1f
+#define SCENE_CENTRE glm::vec3(0.0f, 0.0f, 0.0f)
+
 std::vector<float> interpolateSingleFloats(float from, float to, int numberOfValues) {
 	std::vector<float> result;
 	float spacing;
@@ -59,272 +86,336 @@ glm::vec3 barycentricToRGB(glm::vec3 pos) {
 	return pos * float(255);
 }
 
-void line(DrawingWindow &window, CanvasPoint from, CanvasPoint to, Colour colour) {
-	float xDiff = (to.x-from.x);
-	float yDiff = (to.y-from.y);
-	float numSteps = std::max(abs(xDiff), abs(yDiff));
-	if (numSteps == 0) {
-		uint32_t uintColour = (255 << 24) + (colour.red << 16) + (colour.green << 8) + colour.blue;
-		window.setPixelColour(round(from.x), round(from.y), uintColour);
-		return;
-	}
-	float xStepSize = xDiff/numSteps;
-	float yStepSize = yDiff/numSteps;
-	// repeated addition instead of multiplication (out of bounds)
-	// float x = from.x;
-	// float y = from.y;
-	// for (int i = 0; i <= numSteps; i++) {
-	// 	x += xStepSize;
-	// 	y += yStepSize;
-	// 	uint32_t uintColour = (255 << 24) + (colour.red << 16) + (colour.green << 8) + colour.blue;
-	// 	window.setPixelColour(int(x), int(y), uintColour);
-	// }
-
-	for (float i=0.0; i<=numSteps; i++) {
-		float x = from.x + xStepSize*i;
-		float y = from.y + yStepSize*i;
-		uint32_t uintColour = (255 << 24) + (colour.red << 16) + (colour.green << 8) + colour.blue;
-		window.setPixelColour(round(x), round(y), uintColour);
+#ifndef SDW_HEADLESS
+// Returns whether the event changed anything that needs redrawing. shown is a copy of the frame on screen.
+bool handleEvent(const SDL_Event &event, Framebuffer &shown, ScreenshotWriter &screenshots, int &renderMode, Camera &camera) {
+	if (event.type == SDL_KEYDOWN) {
+		if (event.key.keysym.sym == SDLK_LEFT) camera.orbit(SCENE_CENTRE, -ORBIT_STEP);
+		else if (event.key.keysym.sym == SDLK_RIGHT) camera.orbit(SCENE_CENTRE, ORBIT_STEP);
+		else if (event.key.keysym.sym == SDLK_UP) camera.translate(glm::vec3(0.0f, 0.0f, -MOVE_STEP));
+		else if (event.key.keysym.sym == SDLK_DOWN) camera.translate(glm::vec3(0.0f, 0.0f, MOVE_STEP));
+		else if (event.key.keysym.sym == SDLK_1) renderMode = STROKED;
+		else if (event.key.keysym.sym == SDLK_2) renderMode = FILLED;
+		return true;
+	} else if (event.type == SDL_MOUSEBUTTONDOWN) {
+		// once presented, the window's own pixels are already the next frame's buffer, so they can't be saved
+		if (shown.width != 0) {
+			screenshots.capture(shown.view(), "output.ppm");
+			screenshots.capture(shown.view(), "output.bmp");
+		}
+	} else if (event.type == SDL_WINDOWEVENT) {
+		// covered up, resized and so on: the window needs its contents back
+		return true;
 	}
+	return false;
 }
-
-std::vector<uint32_t> getTexturedLine(CanvasPoint from, CanvasPoint to, std::vector<std::vector<uint32_t>> texture) {
-	float xDiff = to.texturePoint.x-from.texturePoint.x;
-	float yDiff = to.texturePoint.y-from.texturePoint.y;
-	float numSteps = std::max(abs(xDiff), abs(yDiff));
-	std::vector<uint32_t> result;
-
-	if (numSteps == 0) {
-		return {texture[from.texturePoint.y][from.texturePoint.x]};
-	}
-	float xStepSize = xDiff/numSteps;
-	float yStepSize = yDiff/numSteps;
-	for (float i=0.0; i<=numSteps; i++) {
-		float x = from.texturePoint.x + xStepSize*i;
-		float y = from.texturePoint.y + yStepSize*i;
-		result.push_back(texture[y][x]);
+#endif
+
+// Gives every material with a texture its handle to it, loaded through the shared cache. A texture that can't
+// be loaded leaves its material drawn in its plain colour.
+void loadTextures(MaterialTable &materials) {
+	for (size_t id = 0; id < materials.size(); id++) {
+		const std::string &path = materials.texturePath(MaterialId(id));
+		if (path.empty()) continue;
+		try {
+			materials.setTexture(MaterialId(id), TextureCache::shared().get(path));
+		} catch (const std::invalid_argument &error) {
+			std::cout << error.what() << std::endl;
+		}
 	}
-	return result;
 }
 
-void texturedLine(DrawingWindow &window, CanvasPoint from, CanvasPoint to, std::vector<std::vector<uint32_t>> texture) {
-	float xDiff = (to.x-from.x);
-	float yDiff = (to.y-from.y);
-	float numSteps = std::max(abs(xDiff), abs(yDiff));
-	if (numSteps == 0) {
-		uint32_t uintColour = texture[from.texturePoint.x][from.texturePoint.y];
-		window.setPixelColour(round(from.x), round(from.y), uintColour);
-		return;
+// Maps the compiled mesh beside the OBJ when it's up to date (drawing straight from the mapping, which stays
+// open for as long as the mesh does), and otherwise parses the OBJ and MTL (compiling them for next time)
+Mesh loadMesh(const std::string &objFilename, const std::string &mtlFilename) {
+	std::string meshFilename = meshFilenameFor(objFilename);
+	std::shared_ptr<const MeshFile> compiled = std::make_shared<MeshFile>(meshFilename);
+	if (compiled->isCompiledFrom(objFilename, mtlFilename)) return borrowMesh(compiled);
+	// let go of a stale one before it gets replaced
+	compiled.reset();
+	try {
+		Mesh mesh = buildMesh(loadObj(objFilename, mtlFilename).view());
+		if (!writeMeshFile(meshFilename, mesh, objFilename, mtlFilename)) std::cout << "Could not write " << meshFilename << std::endl;
+		return mesh;
+	} catch (const std::invalid_argument &error) {
+		std::cout << error.what() << std::endl;
+		return Mesh();
 	}
-	float xStepSize = xDiff/numSteps;
-	float yStepSize = yDiff/numSteps;
-
-	std::vector<uint32_t> texturedLine = getTexturedLine(from, to, texture);
-	int texturedLineLength = texturedLine.size();
-	for (float i=0.0; i<=numSteps; i++) {
-		float x = from.x + xStepSize*i;
-		float y = from.y + yStepSize*i;
-		int index = texturedLineLength/numSteps * i;
-		uint32_t uintColour = texturedLine[index];
-		window.setPixelColour(round(x), round(y), uintColour);
-	}
-
 }
 
-void drawStrokedTriangle(DrawingWindow &window, CanvasTriangle triangle, Colour colour) {
-	line(window, triangle.v0(), triangle.v1(), colour);
-	line(window, triangle.v1(), triangle.v2(), colour);
-	line(window, triangle.v2(), triangle.v0(), colour);
+// The mesh, with its materials' textures loaded
+Mesh loadModel(const std::string &objFilename, const std::string &mtlFilename) {
+	Mesh mesh = loadMesh(objFilename, mtlFilename);
+	loadTextures(mesh.materialTable);
+	return mesh;
 }
 
-CanvasPoint pointOnLineY(float y, CanvasPoint p1, CanvasPoint p2) {
-	float proportion = (y - p1.y) / (p2.y - p1.y);
-	float x = proportion * (p2.x - p1.x) + p1.x;
-
-	CanvasPoint result = CanvasPoint(x, y);
-	float textureX = proportion * (p2.texturePoint.x-p1.texturePoint.x) + p1.texturePoint.x;
-	float textureY = proportion * (p2.texturePoint.y-p1.texturePoint.y) + p1.texturePoint.y;
-	result.texturePoint = TexturePoint(textureX, textureY);
-
-	return result;
-}
-
-std::vector<CanvasTriangle> splitTriangle(CanvasTriangle triangle) {
-	CanvasTriangle top, bottom;
-	std::vector<CanvasPoint> points = {triangle.v0(), triangle.v1(), triangle.v2()};
-	std::sort(points.begin(),points.end(),
-		[](CanvasPoint p1, CanvasPoint p2) {
-		return (p1.y < p2.y);
-	});
-	// for each y from p1.y to p2.y, we want to print a line
-	// the line goes from proportionalPoint(yVal, p1, p2) to proportionalPoint(yVal, p1, p3)
-	// proportionalPoint(Y, p1, p2) returns a point(X,Y) on a line
-
-	CanvasPoint newPoint = pointOnLineY(points[1].y, points[0], points[2]);
-
-	top.v0() = points[0];
-	top.v1() = points[1];
-	top.v2() = newPoint;
-
-	bottom.v0() = points[1];
-	bottom.v1() = newPoint;
-	bottom.v2() = points[2];
-
-	return {top, bottom};
+// A node's vertices, projected from the camera version and scene version given
+struct ProjectedNode {
+	ProjectedVertices vertices;
+	uint64_t cameraVersion = 0;
+	uint64_t sceneVersion = 0;
+};
+
+// Everything kept from one frame to the next: scratch space that would otherwise be reallocated every time,
+// and what was last worked out from which camera and scene versions, so that work whose inputs are the same as
+// last time can be skipped
+struct FrameState {
+	std::vector<Line> wireframe;
+	std::vector<uint32_t> visibleNodes;
+	std::vector<uint32_t> visible;
+	// one per node of projectedScene
+	std::vector<ProjectedNode> projected;
+	// what's left of a triangle after near clipping, projected
+	ProjectedVertices clipped;
+	const Scene *projectedScene = nullptr;
+	// a copy of the last frame drawn (the one on screen, so screenshots save it), and what it was drawn from
+	Framebuffer lastFrame;
+	uint64_t lastFrameCameraVersion = 0;
+	uint64_t lastFrameSceneVersion = 0;
+	const Scene *lastFrameScene = nullptr;
+	int lastFrameMode = -1;
+	CullStats lastFrameStats;
+};
+
+Projection cameraProjection(const Camera &camera) {
+	return camera.projection(IMAGE_PLANE_SCALE, WIDTH, HEIGHT);
 }
 
-int getHeight(CanvasTriangle triangle) {
-	return std::max({triangle.v0().y, triangle.v1().y, triangle.v2().y}) - std::min({triangle.v0().y, triangle.v1().y, triangle.v2().y});
+// The camera as seen from a node's own space, where its part's vertices can be used as they are
+struct NodeView {
+	const SceneNode &node;
+	const MeshPart &part;
+	glm::vec3 cameraPosition;
+	Projection projection;
+	glm::vec4 near;
+};
+
+NodeView nodeView(const Scene &scene, size_t index, const Camera &camera) {
+	const SceneNode &node = scene.node(index);
+	glm::vec4 near = nearPlane(camera.position(), camera.forward(), NEAR_PLANE_DISTANCE);
+	return NodeView{node, scene.mesh().parts[node.part], node.world.toLocal(camera.position()),
+	                node.world.projectionToLocal(cameraProjection(camera)), node.world.planeToLocal(near)};
 }
 
-void drawFilledTriangle(DrawingWindow &window, CanvasTriangle triangle, Colour colour) {
-	std::vector<CanvasTriangle> triangleSegments = splitTriangle(triangle);
-	CanvasTriangle topTriangle = triangleSegments[0];
-	int height = getHeight(topTriangle);
-	// std::cout << height << std::endl;
-	// std::cout << triangleSegment.v0() << std::endl;
-	for (int i = 0; i < height; i++) {
-		int yVal = topTriangle.v0().y + i;
-		CanvasPoint p1 = pointOnLineY(yVal, topTriangle.v0(), topTriangle.v1());
-		CanvasPoint p2 = pointOnLineY(yVal, topTriangle.v0(), topTriangle.v2());
-		line(window,p1,p2,colour);
+// Every vertex of the node's part projected once, however many triangles share it (and not at all if neither
+// the camera nor the scene has changed since they were last projected)
+const ProjectedVertices &projectNode(FrameState &state, const Scene &scene, size_t index, const NodeView &view, const Camera &camera) {
+	if (state.projectedScene != &scene) {
+		state.projected.assign(scene.nodeCount(), ProjectedNode());
+		state.projectedScene = &scene;
 	}
-
-	CanvasTriangle bottomTriangle = triangleSegments[1];
-	height = getHeight(bottomTriangle);
-	for (int i = 0; i < height; i++) {
-		int yVal = bottomTriangle.v0().y + i;
-		CanvasPoint p1 = pointOnLineY(yVal, bottomTriangle.v2(), bottomTriangle.v1());
-		CanvasPoint p2 = pointOnLineY(yVal, bottomTriangle.v2(), bottomTriangle.v0());
-		line(window,p1,p2,colour);
+	ProjectedNode &projected = state.projected[index];
+	if (projected.cameraVersion != camera.version() || projected.sceneVersion != scene.version()) {
+		projectVertices(view.projection, scene.mesh().positions.data() + view.part.firstVertex, view.part.vertexCount, projected.vertices);
+		projected.cameraVersion = camera.version();
+		projected.sceneVersion = scene.version();
 	}
-
-	Colour white = Colour(255,255,255);
-	drawStrokedTriangle(window, triangle, white);
+	return projected.vertices;
 }
 
-std::vector<std::vector<uint32_t>> loadTexture(std::string filename) {
-	TextureMap textureMap = TextureMap(filename);
-	int tMapHeight = textureMap.height;
-	int tMapWidth = textureMap.width;
-	std::vector<std::vector<uint32_t>> texture;
-	texture.resize(tMapHeight);
-	for (int i = 0; i < tMapHeight; i++) {
-		texture[i].resize(tMapWidth);
+// Writes the triangle's projection (or the projections of what's left of it after near clipping) to out,
+// returning how many there are, texture points and all. projected holds the part's vertices, from its first.
+// Clipped vertices are projected into clippedScratch by projectVertices too, so that a corner the clip kept
+// lands on exactly the same pixel position as it does for the unclipped neighbours sharing it.
+int projectTriangle(const Mesh &mesh, size_t triangle, const ProjectedVertices &projected, const NodeView &view,
+                    ProjectedVertices &clippedScratch, CanvasTriangle out[MAX_NEAR_CLIPPED_TRIANGLES]) {
+	const uint32_t *indices = &mesh.indices[triangle * 3];
+	const glm::vec4 &near = view.near;
+	bool inFront = true;
+	for (int i = 0; i < 3; i++) inFront = inFront && glm::dot(glm::vec3(near), mesh.positions[indices[i]]) + near.w >= 0.0f;
+	if (inFront) {
+		uint32_t first = view.part.firstVertex;
+		out[0] = CanvasTriangle(projected.point(indices[0] - first), projected.point(indices[1] - first), projected.point(indices[2] - first));
+		if (!mesh.texturePoints.empty()) {
+			for (int i = 0; i < 3; i++) out[0][i].texturePoint = TexturePoint(mesh.texturePoints[indices[i]].x, mesh.texturePoints[indices[i]].y);
+		}
+		return 1;
 	}
-	for (int i = 0; i < tMapHeight; i++) {
-		for (int j = 0; j <	tMapWidth; j++) {
-			texture[i][j] = textureMap.pixels[j + i*tMapWidth];
+	ModelTriangle clipped[MAX_NEAR_CLIPPED_TRIANGLES];
+	int clippedCount = clipToPlane(mesh.triangle(triangle), near, clipped);
+	glm::vec3 positions[MAX_NEAR_CLIPPED_TRIANGLES * 3];
+	for (int c = 0; c < clippedCount; c++) std::copy(clipped[c].vertices.begin(), clipped[c].vertices.end(), positions + c * 3);
+	projectVertices(view.projection, positions, size_t(clippedCount) * 3, clippedScratch);
+	for (int c = 0; c < clippedCount; c++) {
+		for (int i = 0; i < 3; i++) {
+			out[c][i] = clippedScratch.point(c * 3 + i);
+			out[c][i].texturePoint = clipped[c].texturePoints[i];
 		}
 	}
-	return texture;
+	return clippedCount;
 }
 
-void drawTexturedTriangle(DrawingWindow &window, CanvasTriangle canvasTriangle, std::vector<std::vector<uint32_t>> texture) {
-	// input:
-	// canvas triangle
-	// texture triangle
-	// METHODOLOGY:
-	// split canvas triangle into two
-	// go row by row
-	// for each row, calculate each point that corresponds to the texture
-	CanvasTriangle topTriangle, bottomTriangle;
-	topTriangle = splitTriangle(canvasTriangle)[0];
-	bottomTriangle = splitTriangle(canvasTriangle)[1];
+Frustum viewFrustum(const Camera &camera) {
+	float tanHalfWidth = (WIDTH / 2.0f) / (camera.focalLength() * IMAGE_PLANE_SCALE);
+	float tanHalfHeight = (HEIGHT / 2.0f) / (camera.focalLength() * IMAGE_PLANE_SCALE);
+	return makeFrustum(camera.position(), camera.right(), camera.up(), camera.forward(), tanHalfWidth, tanHalfHeight, NEAR_PLANE_DISTANCE);
+}
 
-	for (int y = topTriangle.v0().y; y < topTriangle.v1().y; y++) {
-		CanvasPoint p1 = pointOnLineY(y, topTriangle.v0(), topTriangle.v1());
-		CanvasPoint p2 = pointOnLineY(y, topTriangle.v0(), topTriangle.v2());
-		texturedLine(window, p1, p2, texture);
+void drawWireframeScene(Framebuffer &window, FrameState &state, const Scene &scene, const Camera &camera) {
+	// the lines are reused from frame to frame so that building the batch doesn't allocate
+	std::vector<Line> &lines = state.wireframe;
+	lines.clear();
+	const Mesh &mesh = scene.mesh();
+	// nodes wholly out of view would only draw lines that get clipped away
+	cullNodes(scene, viewFrustum(camera), state.visibleNodes);
+	CanvasTriangle inFront[MAX_NEAR_CLIPPED_TRIANGLES];
+	for (uint32_t index : state.visibleNodes) {
+		NodeView view = nodeView(scene, index, camera);
+		const ProjectedVertices &projected = projectNode(state, scene, index, view, camera);
+		for (size_t t = view.part.firstTriangle; t < view.part.firstTriangle + view.part.triangleCount; t++) {
+			uint32_t uintColour = mesh.materialTable.packed(mesh.materials[t]);
+			int inFrontCount = projectTriangle(mesh, t, projected, view, state.clipped, inFront);
+			for (int c = 0; c < inFrontCount; c++) {
+				lines.emplace_back(inFront[c].v0(), inFront[c].v1(), uintColour);
+				lines.emplace_back(inFront[c].v1(), inFront[c].v2(), uintColour);
+				lines.emplace_back(inFront[c].v2(), inFront[c].v0(), uintColour);
+			}
+		}
 	}
+	drawLines(window.view(), lines);
+}
 
-	for (int y = bottomTriangle.v0().y; y < bottomTriangle.v2().y; y++) {
-		CanvasPoint p1 = pointOnLineY(y, bottomTriangle.v2(), bottomTriangle.v1());
-		CanvasPoint p2 = pointOnLineY(y, bottomTriangle.v2(), bottomTriangle.v0());
-
-		texturedLine(window, p1, p2, texture);
+// Texture points in the model are fractions of the texture's width and height, where the renderer wants texels
+void submitTextured(TileRenderer &renderer, CanvasTriangle triangle, const TextureMap &texture) {
+	for (int i = 0; i < 3; i++) {
+		triangle[i].texturePoint.x *= float(texture.width);
+		triangle[i].texturePoint.y *= float(texture.height);
 	}
-	// draw white stroked triangle as outline
-	drawStrokedTriangle(window, canvasTriangle,Colour(255,255,255));
+	renderer.submit(triangle, texture);
 }
 
-void handleEvent(SDL_Event event, DrawingWindow &window) {
-	if (event.type == SDL_KEYDOWN) {
-		if (event.key.keysym.sym == SDLK_LEFT) std::cout << "LEFT" << std::endl;
-		else if (event.key.keysym.sym == SDLK_RIGHT) std::cout << "RIGHT" << std::endl;
-		else if (event.key.keysym.sym == SDLK_UP) std::cout << "UP" << std::endl;
-		else if (event.key.keysym.sym == SDLK_DOWN) std::cout << "DOWN" << std::endl;
-	} else if (event.type == SDL_MOUSEBUTTONDOWN) {
-		window.savePPM("output.ppm");
-		window.saveBMP("output.bmp");
+CullStats drawRasterisedScene(Framebuffer &window, DepthBuffer &depthBuffer, TileRenderer &renderer, FrameState &state, const Scene &scene, const Camera &camera) {
+	const Mesh &mesh = scene.mesh();
+	Frustum frustum = viewFrustum(camera);
+	CullStats stats = cullNodes(scene, frustum, state.visibleNodes);
+	CanvasTriangle inFront[MAX_NEAR_CLIPPED_TRIANGLES];
+	for (uint32_t index : state.visibleNodes) {
+		// the triangles are tested and projected where they are, with the camera taken into the node's space
+		NodeView view = nodeView(scene, index, camera);
+		stats += cullTriangles(mesh, view.part, view.cameraPosition, view.node.world.frustumToLocal(frustum), state.visible);
+		if (state.visible.empty()) continue;
+		const ProjectedVertices &projected = projectNode(state, scene, index, view, camera);
+		for (uint32_t triangle : state.visible) {
+			MaterialId material = mesh.materials[triangle];
+			// clip before projecting, so nothing behind the camera gets divided by a negative z (the renderer
+			// then clips the projection to the guard band, so a triangle the camera is inside of can't produce a
+			// huge bounding box)
+			int inFrontCount = projectTriangle(mesh, triangle, projected, view, state.clipped, inFront);
+			const TextureMap *texture = mesh.texturePoints.empty() ? nullptr : mesh.materialTable.texture(material);
+			for (int c = 0; c < inFrontCount; c++) {
+				if (texture) submitTextured(renderer, inFront[c], *texture);
+				else renderer.submit(inFront[c], mesh.materialTable.packed(material));
+			}
+		}
 	}
+	depthBuffer.clear();
+	renderer.render(window.view(), depthBuffer);
+	return stats;
 }
 
-std::unordered_map<std::string,Colour> parseMaterialFile(std::string filename) {
-	std::ifstream MTL(filename);
-	std::string line, currColour;
-	std::unordered_map<std::string,Colour> colourMap;
-
-	while (getline(MTL, line)) {
-		std::vector<std::string> splitted = split(line, ' ');
-		if (splitted[0] == "newmtl") {
-			currColour = splitted[1];
-			continue;
-		}
-		if (splitted[0] == "Kd") {
-			int r = std::stof(splitted[1]) * 255;
-			int g = std::stof(splitted[2]) * 255;
-			int b = std::stof(splitted[3]) * 255;
-			colourMap[currColour] = Colour(r,g,b);
-		}
+CullStats drawScene(Framebuffer &target, int renderMode, DepthBuffer &depthBuffer, TileRenderer &renderer, FrameState &state, const Scene &scene, const Camera &camera) {
+	bool sameSize = state.lastFrame.width == target.width && state.lastFrame.height == target.height;
+	bool sameScene = state.lastFrameScene == &scene && state.lastFrameSceneVersion == scene.version();
+	if (sameSize && sameScene && state.lastFrameCameraVersion == camera.version() && state.lastFrameMode == renderMode) {
+		// it would only come out the same as last time
+		target.view().blit(0, 0, state.lastFrame.view());
+		return state.lastFrameStats;
 	}
-	return colourMap;
+	target.clearPixels();
+	CullStats stats;
+	if (renderMode == STROKED) drawWireframeScene(target, state, scene, camera);
+	else stats = drawRasterisedScene(target, depthBuffer, renderer, state, scene, camera);
+	if (!sameSize) state.lastFrame = Framebuffer(int(target.width), int(target.height));
+	state.lastFrame.view().blit(0, 0, target.view());
+	state.lastFrameScene = &scene;
+	state.lastFrameSceneVersion = scene.version();
+	state.lastFrameCameraVersion = camera.version();
+	state.lastFrameMode = renderMode;
+	state.lastFrameStats = stats;
+	return stats;
 }
 
-std::vector<ModelTriangle> parseObj(std::string filename, std::unordered_map<std::string,Colour> colourMap) {
-	std::ifstream Obj(filename);
-	std::string line;
-	std::vector<ModelTriangle> modelTriangles;
-	Colour currColour;
-	std::vector<glm::vec3> vertices;
+bool endsWith(const std::string &text, const std::string &suffix) {
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
 
-	while (getline(Obj, line)) {
-		std::vector<std::string> splitted = split(line, ' ');
-		std::string prefix = splitted[0];
-		if (prefix == "usemtl") {
-			currColour = colourMap[splitted[1]];
-			continue;
-		}
-		if (prefix == "v") {
-			float x = std::stof(splitted[1]);
-			float y = std::stof(splitted[2]);
-			float z = std::stof(splitted[3]);
-			glm::vec3 vertex = glm::vec3(x,y,z);
-			vertices.push_back(vertex);
-			continue;
-		}
-		if (prefix == "f") {
-			int index0, index1, index2;
-			index0 = stoi(splitted[1]);
-			index1 = stoi(splitted[2]);
-			index2 = stoi(splitted[3]);
-			ModelTriangle modelTriangle = ModelTriangle(vertices[index0-1], vertices[index1-1], vertices[index2-1], currColour);
-			std::cout << modelTriangle.colour << "\n" << modelTriangle << std::endl;
+int main(int argc, char *argv[]) {
+	// --headless <file> renders a single frame off-screen and saves it (as a BMP if the name ends in .bmp,
+	// otherwise as a PPM), without ever touching SDL. --wireframe starts in the stroked mode.
+	// --record <stream> appends every frame to a Y4M (for "-", meaning stdout, or a .y4m name) or PPM stream.
+	// Headless, it renders a turntable of --frames frames (default 120) instead of a single one.
+	// --threaded-present presents from a thread of its own (see PresentMode::THREADED).
+	std::string headlessOutput;
+	std::string recordPath;
+	int frameCount = 120;
+	int framesPerSecond = 30;
+	int renderMode = FILLED;
+#ifndef SDW_HEADLESS
+	bool threadedPresent = false;
+#endif
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "--headless" && i + 1 < argc) headlessOutput = argv[++i];
+		else if (argument == "--record" && i + 1 < argc) recordPath = argv[++i];
+		else if (argument == "--frames" && i + 1 < argc) frameCount = std::max(1, std::stoi(argv[++i]));
+		else if (argument == "--fps" && i + 1 < argc) framesPerSecond = std::max(1, std::stoi(argv[++i]));
+		else if (argument == "--wireframe") renderMode = STROKED;
+#ifndef SDW_HEADLESS
+		else if (argument == "--threaded-present") threadedPresent = true;
+#endif
+	}
+#ifdef SDW_HEADLESS
+	if (headlessOutput.empty()) headlessOutput = "output.ppm";
+#endif
+	// static, so that quitting (which exits from inside the run loop) still writes out the frames in flight
+	static std::unique_ptr<FrameSink> frameSink;
+	if (!recordPath.empty()) {
+		// the frames have stdout to themselves, so send messages to stderr
+		if (recordPath == "-") std::cout.rdbuf(std::cerr.rdbuf());
+		frameSink.reset(new FrameSink(recordPath, streamFormatFor(recordPath), WIDTH, HEIGHT, framesPerSecond));
+		if (!frameSink->isOpen()) return 1;
+	}
+	Scene scene(loadModel("models/cornell-box.obj", "models/cornell-box.mtl"));
+	DepthBuffer depthBuffer = DepthBuffer(WIDTH, HEIGHT);
+	TileRenderer renderer;
+	FrameState frameState;
+	CullStats lastCullStats;
+	Camera camera(glm::vec3(0.0f, 0.0f, 4.0f), 2.0f);
+
+	if (!headlessOutput.empty()) {
+		Framebuffer target = Framebuffer(WIDTH, HEIGHT);
+		int frames = frameSink ? frameCount : 1;
+		for (int frame = 0; frame < frames; frame++) {
+			// the camera swings round the model, which looks the same as the model turning the other way
+			float angle = 2.0f * float(M_PI) * float(frame) / float(frames);
+			Camera turntable = camera;
+			turntable.orbit(SCENE_CENTRE, -angle);
+			CullStats cullStats = drawScene(target, renderMode, depthBuffer, renderer, frameState, scene, turntable);
+			if (renderMode == FILLED && cullStats != lastCullStats) std::cout << "Culling: " << cullStats << std::endl;
+			lastCullStats = cullStats;
+			if (frameSink) frameSink->submit(target.view());
 		}
+		if (endsWith(headlessOutput, ".bmp")) target.saveBMP(headlessOutput);
+		else target.savePPM(headlessOutput);
+		return 0;
 	}
-	Obj.close();
-	return {};
-}
 
-int main(int argc, char *argv[]) {
-	DrawingWindow window = DrawingWindow(WIDTH, HEIGHT, false);
-	SDL_Event event;
-	std::unordered_map<std::string,Colour> colourMap = parseMaterialFile("models/cornell-box.mtl");
-	std::vector<ModelTriangle> obj = parseObj("models/cornell-box.obj", colourMap);
-	// while (true) {
-	// 	// We MUST poll for events - otherwise the window will freeze !
-	// 	if (window.pollForInputEvents(event)) handleEvent(event, window);
-	// 	// Need to render the frame at the end, or nothing actually gets shown on the screen !
-	// 	window.renderFrame();
-	// }
+#ifndef SDW_HEADLESS
+	DrawingWindow window = DrawingWindow(WIDTH, HEIGHT, false, threadedPresent ? PresentMode::THREADED : PresentMode::DIRECT);
+	// static, so that quitting (which exits from inside the run loop) still finishes any pending screenshots
+	static ScreenshotWriter screenshots;
+	window.recordTo(frameSink.get());
+	// Nothing in the scene moves on its own yet, so there is no update step: the loop sleeps until an event
+	// arrives, and only redraws when one changes something. Even then, if the camera, scene and mode are as they were
+	// (the window was only uncovered, say), the last frame is copied back rather than drawn again.
+	window.run(
+			[&](const SDL_Event &event) { return handleEvent(event, frameState.lastFrame, screenshots, renderMode, camera); },
+			nullptr,
+			[&]() {
+				CullStats cullStats = drawScene(window, renderMode, depthBuffer, renderer, frameState, scene, camera);
+				if (renderMode == FILLED && cullStats != lastCullStats) std::cout << "Culling: " << cullStats << std::endl;
+				lastCullStats = cullStats;
+			});
+#endif
 }